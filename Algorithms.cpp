@@ -1,5 +1,363 @@
 #include "Algorithms.hpp"
 #include "HelpAlgo.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "Gemm.hpp"
+#include "Heaps.hpp"
+
+namespace{
+    // Beamer's thresholds: go bottom-up once the frontier holds more than 1/ALPHA of the unvisited vertices,
+    // and back top-down once it holds less than 1/BETA of all the vertices. A bottom-up vertex has to look at
+    // all its edges to find its earliest parent, so it only pays once the frontier outgrows the rest
+    const size_t ALPHA = 2;
+    const size_t BETA = 24;
+    // AUTO_HEAP runs Dijkstra over Dial's buckets for integral weights up to DIAL_AUTO_MAX, and no bucket
+    // array is allocated for weights above DIAL_MAX
+    const int64_t DIAL_AUTO_MAX = 256;
+    const int64_t DIAL_MAX = 1 << 20;
+
+    /*
+     One top-down level: every vertex of the frontier queue[head, end), in queue order, looks at its own edges and
+     appends the unvisited ones to the queue in ascending order. This is the order of a classic FIFO queue, so every
+     vertex is discovered by the first vertex of the frontier that reaches it. A bitset row is masked with the
+     unvisited vertices, 64 candidates per word.
+    */
+    template<typename W, typename D>
+    void topDownStep(const GraphLib::BasicGraph<W, D> &g, std::vector<size_t> &queue, size_t head, size_t end, size_t &tail,
+                     std::vector<uint64_t> &visited, std::vector<D> &dis, std::vector<int> &pre){
+        for(size_t k = head; k < end; k++){
+            size_t cur = queue[k];
+            const uint64_t *row = g.getBitRow(cur);
+            if(row != nullptr){
+                for(size_t w = 0; w < visited.size(); w++){
+                    uint64_t found = row[w] & ~visited[w];
+                    visited[w] |= found;
+                    for(; found != 0; found &= found - 1){
+                        size_t i = (w << 6) + (size_t)__builtin_ctzll(found);
+                        queue[tail++] = i;
+                        pre[i] = (int)cur;
+                        dis[i] = dis[cur] + 1;
+                    }
+                }
+                continue;
+            }
+            // only the existing edges of cur are visited
+            for(const auto &e : g.neighbours(cur)){
+                size_t i = e.to;
+                uint64_t bit = 1ULL << (i & 63);
+                if((visited[i >> 6] & bit) == 0){
+                    visited[i >> 6] |= bit;
+                    queue[tail++] = i;
+                    pre[i] = (int)cur;
+                    dis[i] = dis[cur] + 1;
+                }
+            }
+        }
+    }
+
+    /*
+     Sorts the level queue[first, last) into the order a FIFO queue discovers it: by the queue position of the parent,
+     given by order, and the vertices of one parent in ascending order, the order its edges are scanned in.
+    */
+    void sortLevel(std::vector<size_t> &queue, size_t first, size_t last, const std::vector<int> &pre, const std::vector<size_t> &order){
+        std::sort(queue.begin() + (std::ptrdiff_t)first, queue.begin() + (std::ptrdiff_t)last, [&](size_t a, size_t b){
+            size_t pa = order[(size_t)pre[a]];
+            size_t pb = order[(size_t)pre[b]];
+            return pa < pb || (pa == pb && a < b);
+        });
+    }
+
+    /*
+     Returns the neighbour of i in the frontier bitmap with the earliest queue position, the number of vertices if none.
+    */
+    template<typename W, typename D>
+    size_t earliestParent(const GraphLib::BasicGraph<W, D> &g, size_t i, const std::vector<uint64_t> &frontier,
+                          const std::vector<size_t> &order){
+        size_t parent = g.getNumVertices();
+        const uint64_t *row = g.getBitRow(i);
+        if(row != nullptr){
+            for(size_t x = 0; x < frontier.size(); x++){
+                for(uint64_t both = row[x] & frontier[x]; both != 0; both &= both - 1){
+                    size_t p = (x << 6) + (size_t)__builtin_ctzll(both);
+                    if(parent == g.getNumVertices() || order[p] < order[parent]){
+                        parent = p;
+                    }
+                }
+            }
+            return parent;
+        }
+        for(const auto &e : g.neighbours(i)){
+            if(((frontier[e.to >> 6] >> (e.to & 63)) & 1) && (parent == g.getNumVertices() || order[e.to] < order[parent])){
+                parent = e.to;
+            }
+        }
+        return parent;
+    }
+
+    /*
+     One bottom-up level of a symmetric graph: every unvisited vertex looks for its parents in the frontier bitmap
+     and takes the one with the earliest queue position, given by order, which is the parent a top-down level would
+     give it. The level is then sorted into the order a top-down level appends it.
+    */
+    template<typename W, typename D>
+    void bottomUpStep(const GraphLib::BasicGraph<W, D> &g, std::vector<size_t> &queue, size_t head, size_t end, size_t &tail,
+                      std::vector<uint64_t> &visited, std::vector<uint64_t> &frontier, const std::vector<size_t> &order,
+                      std::vector<D> &dis, std::vector<int> &pre){
+        size_t len = g.getNumVertices();
+        std::fill(frontier.begin(), frontier.end(), 0ULL);
+        for(size_t k = head; k < end; k++){
+            frontier[queue[k] >> 6] |= 1ULL << (queue[k] & 63);
+        }
+        for(size_t w = 0; w < visited.size(); w++){
+            uint64_t open = ~visited[w];
+            if((w << 6) + 64 > len){
+                open &= (1ULL << (len & 63)) - 1;
+            }
+            for(; open != 0; open &= open - 1){
+                size_t i = (w << 6) + (size_t)__builtin_ctzll(open);
+                size_t parent = earliestParent(g, i, frontier, order);
+                if(parent != len){
+                    visited[w] |= 1ULL << (i & 63);
+                    queue[tail++] = i;
+                    pre[i] = (int)parent;
+                    dis[i] = dis[parent] + 1;
+                }
+            }
+        }
+        sortLevel(queue, end, tail, pre, order);
+    }
+
+    // levels with a smaller frontier are expanded on the calling thread, even by a parallel BFS
+    const size_t PARALLEL_MIN = 1024;
+    // every thread takes this many chunks of a level on average, so the threads finish close together
+    const size_t CHUNKS_PER_THREAD = 8;
+
+    /*
+     Runs work(c) for every chunk c < chunks on the hardware threads, the threads take the chunks from a shared counter.
+    */
+    template<typename F>
+    void forEachChunk(size_t threads, size_t chunks, const F &work){
+        std::atomic<size_t> next(0);
+        GraphLib::Gemm::runThreads(threads, [&](){
+            for(size_t c = next++; c < chunks; c = next++){
+                work(c);
+            }
+        });
+    }
+
+    /*
+     Appends the vertices found by every chunk to the queue, in the order of the chunks.
+    */
+    void appendChunks(std::vector<std::vector<size_t>> &found, std::vector<size_t> &queue, size_t &tail){
+        for(size_t c = 0; c < found.size(); c++){
+            std::copy(found[c].begin(), found[c].end(), queue.begin() + (std::ptrdiff_t)tail);
+            tail += found[c].size();
+        }
+    }
+
+    /*
+     A top-down level on all the threads. The visited bitmap is only read during the level, an unvisited vertex is
+     claimed by the frontier vertex with the earliest queue position that reaches it, with an atomic minimum over that
+     position, and the chunk whose vertex claims it first lists it. The next frontier is marked visited and sorted by
+     the position of the parent once the threads are done, so the result is the same as the sequential step.
+    */
+    template<typename W, typename D>
+    void parallelTopDownStep(const GraphLib::BasicGraph<W, D> &g, size_t threads, std::vector<size_t> &queue, size_t head, size_t end,
+                             size_t &tail, std::vector<uint64_t> &visited, std::vector<std::atomic<size_t>> &parents,
+                             std::vector<D> &dis, std::vector<int> &pre){
+        size_t none = g.getNumVertices();
+        size_t chunks = std::min(end - head, threads * CHUNKS_PER_THREAD);
+        std::vector<std::vector<size_t>> found(chunks);
+        auto claim = [&](size_t i, size_t k, std::vector<size_t> &out){
+            size_t seen = parents[i].load(std::memory_order_relaxed);
+            if(seen == none && parents[i].compare_exchange_strong(seen, k, std::memory_order_relaxed)){
+                out.push_back(i);
+                return;
+            }
+            while(k < seen && !parents[i].compare_exchange_weak(seen, k, std::memory_order_relaxed)){}
+        };
+        forEachChunk(threads, chunks, [&](size_t c){
+            std::vector<size_t> &out = found[c];
+            for(size_t k = head + (end - head) * c / chunks; k < head + (end - head) * (c + 1) / chunks; k++){
+                size_t cur = queue[k];
+                const uint64_t *row = g.getBitRow(cur);
+                if(row != nullptr){
+                    for(size_t w = 0; w < visited.size(); w++){
+                        for(uint64_t bits = row[w] & ~visited[w]; bits != 0; bits &= bits - 1){
+                            claim((w << 6) + (size_t)__builtin_ctzll(bits), k, out);
+                        }
+                    }
+                    continue;
+                }
+                for(const auto &e : g.neighbours(cur)){
+                    if(((visited[e.to >> 6] >> (e.to & 63)) & 1) == 0){
+                        claim(e.to, k, out);
+                    }
+                }
+            }
+        });
+        size_t first = tail;
+        appendChunks(found, queue, tail);
+        std::sort(queue.begin() + (std::ptrdiff_t)first, queue.begin() + (std::ptrdiff_t)tail, [&](size_t a, size_t b){
+            size_t pa = parents[a].load(std::memory_order_relaxed);
+            size_t pb = parents[b].load(std::memory_order_relaxed);
+            return pa < pb || (pa == pb && a < b);
+        });
+        for(size_t k = first; k < tail; k++){
+            size_t i = queue[k];
+            size_t parent = queue[parents[i].load(std::memory_order_relaxed)];
+            visited[i >> 6] |= 1ULL << (i & 63);
+            pre[i] = (int)parent;
+            dis[i] = dis[parent] + 1;
+        }
+    }
+
+    /*
+     A bottom-up level on all the threads. Every chunk is a range of words of the visited bitmap, so a thread only
+     writes the bits, the parents and the distances of its own vertices. Every vertex takes its earliest parent like
+     the sequential step, and the level is sorted the same way once the threads are done.
+    */
+    template<typename W, typename D>
+    void parallelBottomUpStep(const GraphLib::BasicGraph<W, D> &g, size_t threads, std::vector<size_t> &queue, size_t head, size_t end,
+                              size_t &tail, std::vector<uint64_t> &visited, std::vector<uint64_t> &frontier,
+                              const std::vector<size_t> &order, std::vector<D> &dis, std::vector<int> &pre){
+        size_t len = g.getNumVertices();
+        std::fill(frontier.begin(), frontier.end(), 0ULL);
+        for(size_t k = head; k < end; k++){
+            frontier[queue[k] >> 6] |= 1ULL << (queue[k] & 63);
+        }
+        size_t chunks = std::min(visited.size(), threads * CHUNKS_PER_THREAD);
+        std::vector<std::vector<size_t>> found(chunks);
+        forEachChunk(threads, chunks, [&](size_t c){
+            std::vector<size_t> &out = found[c];
+            for(size_t w = visited.size() * c / chunks; w < visited.size() * (c + 1) / chunks; w++){
+                uint64_t open = ~visited[w];
+                if((w << 6) + 64 > len){
+                    open &= (1ULL << (len & 63)) - 1;
+                }
+                for(; open != 0; open &= open - 1){
+                    size_t i = (w << 6) + (size_t)__builtin_ctzll(open);
+                    size_t parent = earliestParent(g, i, frontier, order);
+                    if(parent != len){
+                        visited[w] |= 1ULL << (i & 63);
+                        pre[i] = (int)parent;
+                        dis[i] = dis[parent] + 1;
+                        out.push_back(i);
+                    }
+                }
+            }
+        });
+        appendChunks(found, queue, tail);
+        sortLevel(queue, end, tail, pre, order);
+    }
+
+    /*
+     The levels of a BFS whose first level, queue[0, tail), is already visited and has its distances.
+     The queue has a slot for every vertex, which enters it at most once, so it is never reallocated and a level is the
+     range of the queue between two indices. The visited vertices are kept as a bitmap.
+     An undirected graph whose matrix is symmetric switches to bottom-up levels while the frontier is large
+     (direction optimizing BFS), then the unvisited vertices look for a parent instead of the frontier scanning all of its edges.
+     Either way every vertex gets the parent and the queue position a classic FIFO queue gives it, so the result
+     does not depend on the direction and is the one of a BFS that pops one vertex at a time.
+     A parallel search expands the levels of at least PARALLEL_MIN vertices on all the hardware threads, with the same result.
+     Returns the number of vertices in the queue, which holds them in the order they were discovered.
+    */
+    template<typename W, typename D>
+    size_t searchLevels(const GraphLib::BasicGraph<W, D> &g, std::vector<size_t> &queue, size_t tail, std::vector<uint64_t> &visited,
+                        std::vector<D> &dis, std::vector<int> &pre, GraphLib::Algorithms::Execution policy){
+        size_t len = g.getNumVertices();
+        size_t unvisited = len;
+        for(size_t w = 0; w < visited.size(); w++){
+            unvisited -= (size_t)__builtin_popcountll(visited[w]);
+        }
+        std::vector<uint64_t> frontier;
+        // the queue position of every vertex of the frontier, read by the steps that do not expand it in queue order
+        std::vector<size_t> order(len);
+        size_t head = 0;
+        // a bottom-up step follows the edges into a vertex, so it needs every edge in both directions,
+        // which setUnDirected does not guarantee
+        bool symmetric = !g.isDirected() && g.isSymmetricMatrix();
+        bool bottomUp = false;
+        size_t threads = 1;
+        std::vector<std::atomic<size_t>> parents;
+        if(policy == GraphLib::Algorithms::PARALLEL){
+            threads = std::max(1u, std::thread::hardware_concurrency());
+            parents = std::vector<std::atomic<size_t>>(len);
+            for(size_t i = 0; i < len; i++){
+                parents[i].store(len, std::memory_order_relaxed);
+            }
+        }
+        while(head < tail){
+            size_t end = tail;
+            size_t size = end - head;
+            if(symmetric){
+                bottomUp = bottomUp ? size >= len / BETA : size > unvisited / ALPHA;
+            }
+            bool parallel = policy == GraphLib::Algorithms::PARALLEL && size >= PARALLEL_MIN;
+            if(bottomUp){
+                for(size_t k = head; k < end; k++){
+                    order[queue[k]] = k;
+                }
+                frontier.resize(visited.size());
+                if(parallel){
+                    parallelBottomUpStep(g, threads, queue, head, end, tail, visited, frontier, order, dis, pre);
+                }
+                else{
+                    bottomUpStep(g, queue, head, end, tail, visited, frontier, order, dis, pre);
+                }
+            }
+            else if(parallel){
+                parallelTopDownStep(g, threads, queue, head, end, tail, visited, parents, dis, pre);
+            }
+            else{
+                topDownStep(g, queue, head, end, tail, visited, dis, pre);
+            }
+            unvisited -= tail - end;
+            head = end;
+        }
+        return tail;
+    }
+
+    /*
+     Dijkstra's loop over the given queue. The queue pops the smallest distance and the smallest vertex among
+     equal distances, so every queue settles the vertices in the same order. A radix heap may hold old entries
+     of a vertex, they are popped after the vertex was settled and skipped.
+    */
+    template<typename W, typename D, typename Q>
+    void settleFrom(const GraphLib::BasicGraph<W, D> &g, Q &queue, size_t src, size_t dst, std::vector<D> &dis, std::vector<int> &pre){
+        std::vector<bool> settled(g.getNumVertices(), false);
+        dis[src] = 0;
+        queue.push(src);
+        while(!queue.empty()){
+            size_t u = queue.pop();
+            if(settled[u]){
+                continue;
+            }
+            settled[u] = true;
+            if(u == dst){
+                return;
+            }
+            for(const auto &e : g.neighbours(u)){
+                size_t v = e.to;
+                D d = dis[u] + e.weight;
+                if(settled[v] || d >= dis[v]){
+                    continue;
+                }
+                bool queued = dis[v] != GraphLib::infinity<D>();
+                dis[v] = d;
+                pre[v] = (int)u;
+                if(queued){
+                    queue.decrease(v);
+                }
+                else{
+                    queue.push(v);
+                }
+            }
+        }
+    }
+}
+
 /*
  This function checks if a given graph is connected.
  If the graph is undirected then it uses the BFS algorithm to traverse the graph 
@@ -7,17 +365,18 @@
  If the graph is directed then it uses the DFS algorithm to traverse the graph
     and then runs BFS from the last root of the DFS to check if all the vertices were visited. 
 */
-std::string GraphLib::Algorithms::isConnected(const Graph &g){
+template<typename W, typename D>
+std::string GraphLib::Algorithms::isConnected(const BasicGraph<W, D> &g, Execution policy){
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
     size_t len = g.getNumVertices();
     if(!g.isDirected()){
         // if the graph is undirected run a single BFS
-        std::vector<int> dis(len, INT_MAX);
+        std::vector<D> dis(len, infinity<D>());
         std::vector<int> pre(len, -1);
         std::vector<int> col(len, WHITE);
-        BFS(g, 0, dis, pre, col);
+        BFS(g, 0, dis, pre, col, policy);
         for(size_t i = 0; i< len; i++){
             if(col[i] == WHITE){
                 return "The graph is not connected.";
@@ -42,12 +401,12 @@ std::string GraphLib::Algorithms::isConnected(const Graph &g){
             }
         }
     }
+    std::vector<D> bfsDis(len, infinity<D>());
     for(size_t i = 0; i< len; i++){
         col[i] = WHITE;
         pre[i] = -1;
-        dis[i] = INT_MAX;
     }
-    BFS(g, (size_t)lastRoot, dis, pre, col);
+    BFS(g, (size_t)lastRoot, bfsDis, pre, col, policy);
     for(size_t i = 0; i< len; i++){
         if(col[i] == WHITE){
             return "The graph is not connected.";
@@ -59,7 +418,8 @@ std::string GraphLib::Algorithms::isConnected(const Graph &g){
  This function uses BFS if the graph is unweighted, Dijkstra if the graph has no
     negative values and Bellman-Ford if the graph has negative values.
 */
-std::string GraphLib::Algorithms::shortestPath(const Graph &g, size_t src, size_t dst){
+template<typename W, typename D>
+std::string GraphLib::Algorithms::shortestPath(const BasicGraph<W, D> &g, size_t src, size_t dst, Execution policy, Heap heap){
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
@@ -70,46 +430,45 @@ std::string GraphLib::Algorithms::shortestPath(const Graph &g, size_t src, size_
     if(src == dst){
         return "The shortest path is: " + std::to_string(src);
     }
-    std::vector<int> dis(len, INT_MAX);
+    std::vector<D> dis(len, infinity<D>());
     std::vector<int> pre(len, -1);
     if(!g.isWeighted()){ // the graph has no weights
         std::vector<int> col(len, WHITE);
-        BFS(g, src, dis, pre, col);
-        if(dis[dst] == INT_MAX){
+        BFS(g, src, dis, pre, col, policy);
+        if(dis[dst] == infinity<D>()){
             return "There is no path between " + std::to_string(src) + " and " + std::to_string(dst) + ".";
     }
         return "The shortest path is: " + getPath(pre, src, dst, len);
     }
     if(g.isNegValues()){ // the graph has negative values
-        Graph temp;
+        // the copy shares the storage of g until the first edge is removed
+        BasicGraph<W, D> temp = g;
+        // the flags are taken from the matrix, as when it is loaded
+        temp.updateGraphFlags();
         // remove all the negative weight cycles that are in the graph
         // if the vetrtices are connected via a cycle then any path is invalid
         std::vector<int> cyc;
-        std::vector<std::vector<int>> newGraph = g.getGraph();
-        temp.loadGraph(newGraph);
         std::string cycle = negativeCycle(temp);
         while(cycle != "The graph has no negative cycle."){
             cycle = cycle.substr(23, cycle.size() - 23);
             std::vector<int> path = parsePath(cycle);
             for(size_t i = 0; i < path.size() - 1; i++){
-                newGraph[(size_t)path[i]][(size_t)path[i+1]] = NO_EDGE;
+                temp.removeEdge((size_t)path[i], (size_t)path[i+1]);
             } 
-            temp.loadGraph(newGraph);
             cycle = negativeCycle(temp);
         }
-        temp.loadGraph(newGraph);
         dis[src] = 0;
         // find the shortest path in the cycle free graph
         bellmanFord(temp, dis, pre, cyc);
-        if(dis[dst] == INT_MAX){
+        if(dis[dst] == infinity<D>()){
             std::vector<int> col(len, WHITE);
             for(size_t i = 0; i < len; i++){
-                dis[i] = INT_MAX;
+                dis[i] = infinity<D>();
                 pre[i] = -1;
             }
             // if the vertices are connected in the original graph
-            BFS(g, src, dis, pre, col);
-            if(dis[dst] != INT_MAX){
+            BFS(g, src, dis, pre, col, policy);
+            if(dis[dst] != infinity<D>()){
                 return std::to_string(src) + " and " + std::to_string(dst) + " are connected by a negative weight cycle.";
             }
             // originally there was no path
@@ -118,8 +477,8 @@ std::string GraphLib::Algorithms::shortestPath(const Graph &g, size_t src, size_
         return "The shortest path is: " + getPath(pre, src, dst, len);
     }
     // there are weights but they are not negative
-    Dijkstra(g, src, dis, pre);
-    if(dis[dst] == INT_MAX){
+    Dijkstra(g, src, dis, pre, heap, dst);
+    if(dis[dst] == infinity<D>()){
         return "There is no path between " + std::to_string(src) + " and " + std::to_string(dst) + ".";
     }
     return "The shortest path is: " + getPath(pre, src, dst, len);
@@ -131,7 +490,8 @@ std::string GraphLib::Algorithms::shortestPath(const Graph &g, size_t src, size_
  It does so by running DFS on the graph and checking if there is a back edge.
  If there is a back edge then there is a cycle.
 */
-std::string GraphLib::Algorithms::isContainsCycle(const Graph &g){
+template<typename W, typename D>
+std::string GraphLib::Algorithms::isContainsCycle(const BasicGraph<W, D> &g){
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
@@ -159,7 +519,8 @@ std::string GraphLib::Algorithms::isContainsCycle(const Graph &g){
  It does so by running BFS on the graph and coloring the vertices in two colors.
  If there is an edge between two vertices of the same color then the graph is not bipartite.
 */
-std::string GraphLib::Algorithms::isBipartite(const Graph &g){
+template<typename W, typename D>
+std::string GraphLib::Algorithms::isBipartite(const BasicGraph<W, D> &g){
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
@@ -170,16 +531,18 @@ std::string GraphLib::Algorithms::isBipartite(const Graph &g){
     // if the graph is directed make it an undirected graph
     // the directed graph is bipartite if and only if the undirected graph is bipartite
     if(g.isDirected()){
-        Graph undirectedGraph = g;
-        std::vector<std::vector<int>> newGraph = g.getGraph();
+        BasicGraph<W, D> undirectedGraph = g;
+        std::vector<typename BasicGraph<W, D>::EdgeUpdate> mirrors;
         for(size_t i = 0; i < len; i++){
-            for(size_t j = 0; j < len; j++){
-                if(g.getWeight(i, j) != NO_EDGE){
-                    newGraph[j][i] = 1;
-                }
+            for(const auto &e : g.neighbours(i)){
+                // both directions get the same weight, so the pair is symmetric whatever the original weight was
+                mirrors.push_back({i, e.to, static_cast<W>(1)});
+                mirrors.push_back({e.to, i, static_cast<W>(1)});
             }        
         }
-        undirectedGraph.loadGraph(newGraph);
+        // the flags are taken from the matrix, so the mirrored graph is undirected and the recursion ends
+        undirectedGraph.updateGraphFlags();
+        undirectedGraph.applyUpdates(mirrors.data(), mirrors.size());
         return isBipartite(undirectedGraph);
     }
     // go through all the vertices, if the vertex is white then color it gray
@@ -189,46 +552,43 @@ std::string GraphLib::Algorithms::isBipartite(const Graph &g){
     for(size_t i = 0; i < len; i++){
         if(col[i] == WHITE){
             // self edge will make it automatically not bipartite
-            if(g.getWeight(i, i) != NO_EDGE){
+            if(g.weightAt(i, i) != NO_EDGE){
                 return "The graph is not bipartite.";
             }
             col[i] = GRAY;
             A.push_back(i);
-            for(size_t j = 0; j < len; j++){
-                if(g.getWeight(i, j) != NO_EDGE){
-                    if(col[j] == WHITE){
-                        col[j] = BLACK;
-                        B.push_back(j);
-                    }
-                    else if(col[j] == GRAY){
-                        return "The graph is not bipartite.";
-                    }
+            for(const auto &e : g.neighbours(i)){
+                size_t j = e.to;
+                if(col[j] == WHITE){
+                    col[j] = BLACK;
+                    B.push_back(j);
+                }
+                else if(col[j] == GRAY){
+                    return "The graph is not bipartite.";
                 }
             }
         }
         if(col[i] == BLACK){
-            for(size_t j = 0; j < len; j++){
-                if(g.getWeight(i, j) != NO_EDGE){
-                    if(col[j] == WHITE){
-                        col[j] = GRAY;
-                        A.push_back(j);
-                    }
-                    else if(col[j] == BLACK){
-                        return "The graph is not bipartite.";
-                    }
+            for(const auto &e : g.neighbours(i)){
+                size_t j = e.to;
+                if(col[j] == WHITE){
+                    col[j] = GRAY;
+                    A.push_back(j);
+                }
+                else if(col[j] == BLACK){
+                    return "The graph is not bipartite.";
                 }
             }
         }
         if(col[i] == GRAY){
-            for(size_t j = 0; j < len; j++){
-                if(g.getWeight(i, j) != NO_EDGE){
-                    if(col[j] == WHITE){
-                        col[j] = BLACK;
-                        B.push_back(j);
-                    }
-                    else if(col[j] == GRAY){
-                        return "The graph is not bipartite.";
-                    }
+            for(const auto &e : g.neighbours(i)){
+                size_t j = e.to;
+                if(col[j] == WHITE){
+                    col[j] = BLACK;
+                    B.push_back(j);
+                }
+                else if(col[j] == GRAY){
+                    return "The graph is not bipartite.";
                 }
             }
         }
@@ -256,7 +616,8 @@ std::string GraphLib::Algorithms::isBipartite(const Graph &g){
  it to all other vertices with weight 1.
  Then it runs the Bellman-Ford algorithm on the new graph.
 */
-std::string GraphLib::Algorithms::negativeCycle(const Graph &g){
+template<typename W, typename D>
+std::string GraphLib::Algorithms::negativeCycle(const BasicGraph<W, D> &g){
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
@@ -264,28 +625,32 @@ std::string GraphLib::Algorithms::negativeCycle(const Graph &g){
         return "The graph has no negative cycle.";
     }
     size_t len = g.getNumVertices();
+    size_t size = len + 1;
     // create a new graph with an additional vertex
-    std::vector<std::vector<int>> newGraph(len +1, std::vector<int>(len + 1, NO_EDGE));
+    typename BasicGraph<W, D>::Matrix newGraph(size * size, static_cast<W>(NO_EDGE));
     // add an edge from the new vertex to all other vertices
     for(size_t i = 0; i<len; i++){
-        newGraph[len][i] = 1; 
+        newGraph[len * size + i] = 1; 
     }
-    // copy all the edges to the new graph
+    // copy all the edges to the new graph, a dense row at a time
     for(size_t i = 0; i < len; i++){
-        for(size_t j = 0; j < len; j++){
-            if(g.getWeight(i, j) != NO_EDGE){
-                newGraph[i][j] = g.getWeight(i, j);
-            }
+        RowSpan<W> row = g.getRow(i);
+        if(!row.empty()){
+            std::copy(row.begin(), row.end(), newGraph.begin() + (std::ptrdiff_t)(i * size));
+            continue;
+        }
+        for(const auto &e : g.neighbours(i)){
+            newGraph[i * size + e.to] = e.weight;
         }
     }
-    Graph temp;
+    BasicGraph<W, D> temp;
     // no need for try-catch block since if the new graph is not squared
     // then the original graph was illegal to begin with.
-    temp.loadGraph(newGraph);
+    temp.loadGraph(size, std::move(newGraph));
     if(!g.isDirected()){
         temp.setUnDirected();
     }
-    std::vector<int> dis(len + 1, INT_MAX);
+    std::vector<D> dis(len + 1, infinity<D>());
     std::vector<int> pre(len + 1, -1);
     std::vector<int> cycle;
     // the starting distance is -1 because the edge weight is 1
@@ -306,6 +671,109 @@ std::string GraphLib::Algorithms::negativeCycle(const Graph &g){
     
 }
 
+/*
+ This function runs one BFS whose first level holds all the sources, then every vertex takes the owner of its parent,
+ in the order of the queue, so the parent already has its owner.
+*/
+template<typename W, typename D>
+GraphLib::Algorithms::NearestSource<D> GraphLib::Algorithms::multiSourceBFS(const BasicGraph<W, D> &g, const std::vector<size_t> &sources,
+                                                                           Execution policy){
+    if(!g.isLoaded()){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    size_t len = g.getNumVertices();
+    std::vector<size_t> seeds(sources);
+    std::sort(seeds.begin(), seeds.end());
+    seeds.erase(std::unique(seeds.begin(), seeds.end()), seeds.end());
+    if(!seeds.empty() && seeds.back() >= len){
+        throw std::invalid_argument("The given vertices are out of range.");
+    }
+    NearestSource<D> result;
+    result.dis.assign(len, infinity<D>());
+    result.owner.assign(len, -1);
+    std::vector<int> pre(len, -1);
+    std::vector<uint64_t> visited((len + 63) / 64, 0);
+    std::vector<size_t> queue(len);
+    for(size_t k = 0; k < seeds.size(); k++){
+        size_t s = seeds[k];
+        visited[s >> 6] |= 1ULL << (s & 63);
+        queue[k] = s;
+        result.dis[s] = 0;
+        result.owner[s] = (int)s;
+    }
+    size_t tail = searchLevels(g, queue, seeds.size(), visited, result.dis, pre, policy);
+    for(size_t k = seeds.size(); k < tail; k++){
+        result.owner[queue[k]] = result.owner[(size_t)pre[queue[k]]];
+    }
+    return result;
+}
+
+/*
+ This function searches the sources in batches of 64. Bit k of seen[v] tells whether source k reached v, and bit k of
+ frontier[v] whether it reached v on the last level. A level ors the frontier word of every active vertex into the
+ next word of its neighbours, the bits a vertex had not seen yet are its new frontier and get the level as distance.
+*/
+template<typename W, typename D>
+std::vector<std::vector<D>> GraphLib::Algorithms::sourceDistances(const BasicGraph<W, D> &g, const std::vector<size_t> &sources){
+    if(!g.isLoaded()){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    size_t len = g.getNumVertices();
+    for(size_t k = 0; k < sources.size(); k++){
+        if(sources[k] >= len){
+            throw std::invalid_argument("The given vertices are out of range.");
+        }
+    }
+    std::vector<std::vector<D>> result(sources.size(), std::vector<D>(len, infinity<D>()));
+    std::vector<uint64_t> seen(len);
+    std::vector<uint64_t> frontier(len);
+    std::vector<uint64_t> next(len, 0);
+    std::vector<size_t> active;
+    std::vector<size_t> touched;
+    for(size_t first = 0; first < sources.size(); first += 64){
+        size_t count = std::min<size_t>(64, sources.size() - first);
+        std::fill(seen.begin(), seen.end(), 0ULL);
+        std::fill(frontier.begin(), frontier.end(), 0ULL);
+        active.clear();
+        for(size_t k = 0; k < count; k++){
+            size_t s = sources[first + k];
+            if(frontier[s] == 0){
+                active.push_back(s);
+            }
+            seen[s] |= 1ULL << k;
+            frontier[s] |= 1ULL << k;
+            result[first + k][s] = 0;
+        }
+        for(D level = 1; !active.empty(); level++){
+            touched.clear();
+            for(size_t u : active){
+                for(const auto &e : g.neighbours(u)){
+                    if(next[e.to] == 0){
+                        touched.push_back(e.to);
+                    }
+                    next[e.to] |= frontier[u];
+                }
+                frontier[u] = 0;
+            }
+            active.clear();
+            for(size_t v : touched){
+                uint64_t fresh = next[v] & ~seen[v];
+                next[v] = 0;
+                if(fresh == 0){
+                    continue;
+                }
+                seen[v] |= fresh;
+                frontier[v] = fresh;
+                active.push_back(v);
+                for(; fresh != 0; fresh &= fresh - 1){
+                    result[first + (size_t)__builtin_ctzll(fresh)][v] = level;
+                }
+            }
+        }
+    }
+    return result;
+}
+
 std::string GraphLib::getPath(std::vector<int> &pre, size_t src, size_t dst, int len){
     if(len < 2){
         return std::to_string(src);
@@ -316,33 +784,37 @@ std::string GraphLib::getPath(std::vector<int> &pre, size_t src, size_t dst, int
     return getPath(pre, src, (size_t)pre[dst], len-1) + "->" + std::to_string(dst);
 }
 
-void GraphLib::BFS(const Graph &g, size_t src,std::vector<int> &dis, std::vector<int> &pre, std::vector<int> &col){
+/*
+ A level synchronous BFS from a single source, the vertices that are not white are never discovered again.
+ Every vertex gets the parent a FIFO queue gives it, the first vertex of the previous level that reaches it (see searchLevels).
+*/
+template<typename W, typename D>
+void GraphLib::BFS(const BasicGraph<W, D> &g, size_t src,std::vector<D> &dis, std::vector<int> &pre, std::vector<int> &col,
+                   Algorithms::Execution policy){
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
     size_t len = g.getNumVertices();
-    std::vector<int> q;
-    q.push_back(src);
-    col[src] = GRAY;
+    std::vector<uint64_t> visited((len + 63) / 64, 0);
+    for(size_t i = 0; i < len; i++){
+        if(col[i] != WHITE){
+            visited[i >> 6] |= 1ULL << (i & 63);
+        }
+    }
+    visited[src >> 6] |= 1ULL << (src & 63);
+    std::vector<size_t> queue(len);
+    queue[0] = src;
     pre[src] = -1;
     dis[src] = 0;
-    while(!q.empty()){
-        int cur = q[0];
-        q.erase(q.begin());
-        for(size_t i = 0; i< len; i++){
-            if(g.getWeight((size_t)cur, i) != NO_EDGE && (col[i] == WHITE)){
-                
-                q.push_back(i);
-                col[i] = GRAY;
-                pre[i] = cur;
-                dis[i] = dis[(size_t)cur] + 1;
-            }
-        }
-        col[(size_t)cur] = BLACK;
+    size_t tail = searchLevels(g, queue, 1, visited, dis, pre, policy);
+    // every discovered vertex was also expanded
+    for(size_t k = 0; k < tail; k++){
+        col[queue[k]] = BLACK;
     }
 }
 
-void GraphLib::DFS(const Graph &g, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &dis, std::vector<int> &fin) { 
+template<typename W, typename D>
+void GraphLib::DFS(const BasicGraph<W, D> &g, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &dis, std::vector<int> &fin) { 
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
@@ -354,14 +826,16 @@ void GraphLib::DFS(const Graph &g, std::vector<int> &col, std::vector<int> &pre,
     }
 }
 
-void GraphLib::DFS_VISIT(const Graph &g, size_t v, std::vector<int> &col, std::vector<int> &pre, int &time,std::vector<int> &dis, std::vector<int> &fin) {
+template<typename W, typename D>
+void GraphLib::DFS_VISIT(const BasicGraph<W, D> &g, size_t v, std::vector<int> &col, std::vector<int> &pre, int &time,std::vector<int> &dis, std::vector<int> &fin) {
     col[v] = 1; // Mark vertex as visited (color it gray)
     time++;
     dis[v] = time;
     // Perform any necessary operations on the vertex v
     
-    for (size_t i = 0; i < g.getNumVertices(); i++) {
-        if (g.getWeight(v, i) != NO_EDGE && col[i] == WHITE) {
+    for (const auto &e : g.neighbours(v)) {
+        size_t i = e.to;
+        if (col[i] == WHITE) {
             pre[i] = v; // Set the predecessor of vertex i to v
             DFS_VISIT(g, i, col, pre, time,dis, fin); // Recursively visit the adjacent vertices
         }
@@ -373,19 +847,21 @@ void GraphLib::DFS_VISIT(const Graph &g, size_t v, std::vector<int> &col, std::v
     fin[v] = time;
 }
 
-void GraphLib::DFSDetectCycle(const Graph &g, size_t v, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &cycle) {
+template<typename W, typename D>
+void GraphLib::DFSDetectCycle(const BasicGraph<W, D> &g, size_t v, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &cycle) {
     col[v] = GRAY; // Mark vertex as visited (color it gray)
     // Perform any necessary operations on the vertex v
     
-    for (size_t i = 0; i < g.getNumVertices(); i++) {
+    for (const auto &e : g.neighbours(v)) {
+        size_t i = e.to;
         if(!cycle.empty()){
             return;
         }
-        if (g.getWeight(v, i) != NO_EDGE && col[i] == WHITE) {
+        if (col[i] == WHITE) {
             pre[i] = v; // Set the predecessor of vertex i to v
             DFSDetectCycle(g, i, col, pre, cycle); // Recursively visit the adjacent vertices
         }
-        else if (g.getWeight(v, i) != NO_EDGE && col[i] == GRAY){// Found a back edge 
+        else if (col[i] == GRAY){// Found a back edge 
             if(g.isDirected()){
                 cycle.push_back(i);
                 cycle.push_back(v);
@@ -398,47 +874,52 @@ void GraphLib::DFSDetectCycle(const Graph &g, size_t v, std::vector<int> &col, s
             }
         }
     }
+    if(!cycle.empty()){
+        return;
+    }
     col[v] = BLACK; // Mark vertex as finished (color it black)
 }
 
-void GraphLib::relax(size_t u, size_t v, int weight, std::vector<int> &dis, std::vector<int> &pre) {
+template<typename W, typename D>
+void GraphLib::relax(size_t u, size_t v, W weight, std::vector<D> &dis, std::vector<int> &pre) {
     if (dis[u] + weight < dis[v]) {
         dis[v] = dis[u] + weight;
         pre[v] = u;
     }
 }
 
-void GraphLib::Dijkstra(const Graph &g, size_t src, std::vector<int>& dis, std::vector<int>& pre) {
-    size_t len = g.getNumVertices();
-    std::vector<bool> visited(len, false);
-    
-    dis[src] = 0;
-    
-    for (size_t i = 0; i < len - 1; i++) {
-        int minDist = INT_MAX;
-        int minIndex = -1;
-        
-        // Find the vertex with the minimum distance
-        for (size_t v = 0; v < len; v++) {
-            if (!visited[v] && dis[v] < minDist) {
-                minDist = dis[v];
-                minIndex = v;
-            }
-        }
-        if(minIndex == -1){
-            continue;
-        }
-        // Mark the vertex as visited
-        visited[(size_t)minIndex] = true;
-        
-        // Update the distances of the adjacent vertices
-        for (size_t v = 0; v < len; v++) {
-            if (g.getWeight((size_t)minIndex, v) != NO_EDGE && !visited[v] && dis[(size_t)minIndex] != INT_MAX&& dis[(size_t)minIndex] + g.getWeight((size_t)minIndex, v) < dis[v]) { // && dis[minIndex] + g.adjTable[minIndex][v] < dis[v]
-                // relax(minIndex, v, g.adjTable[minIndex][v], dis, pre);
-                dis[v] = dis[(size_t)minIndex] + g.getWeight((size_t)minIndex, v);
-                pre[v] = minIndex;
-            }
-        }
+/*
+ This function is an implementation of Dijkstra's algorithm over a priority queue, O((V+E) log V) with
+ the heaps instead of the O(V^2) scan for the closest vertex, or O(V+E+W) with Dial's buckets for integral
+ weights up to W. The radix heap and the buckets need integral distances, floating point ones fall back to
+ the 4-ary heap, and so do buckets for weights too large to allocate a bucket per weight.
+*/
+template<typename W, typename D>
+void GraphLib::Dijkstra(const BasicGraph<W, D> &g, size_t src, std::vector<D>& dis, std::vector<int>& pre,
+                        Algorithms::Heap heap, size_t dst) {
+    // the bound of the largest weight sizes the bucket array, integral weights only
+    int64_t maxWeight = DIAL_MAX + 1;
+    if(std::is_integral<D>::value && (heap == Algorithms::AUTO_HEAP || heap == Algorithms::DIAL_BUCKETS)){
+        maxWeight = static_cast<int64_t>(g.maxWeightBound());
+    }
+    if(heap == Algorithms::AUTO_HEAP){
+        heap = maxWeight <= DIAL_AUTO_MAX ? Algorithms::DIAL_BUCKETS : Algorithms::DARY_HEAP;
+    }
+    if(heap == Algorithms::DIAL_BUCKETS && maxWeight <= DIAL_MAX){
+        Heaps::BucketQueue<D> queue(dis, static_cast<uint64_t>(std::max<int64_t>(maxWeight, 1)));
+        settleFrom(g, queue, src, dst, dis, pre);
+    }
+    else if(heap == Algorithms::RADIX_HEAP && std::is_integral<D>::value){
+        Heaps::RadixHeap<D> queue(dis);
+        settleFrom(g, queue, src, dst, dis, pre);
+    }
+    else if(heap == Algorithms::PAIRING_HEAP){
+        Heaps::PairingHeap<D> queue(dis);
+        settleFrom(g, queue, src, dst, dis, pre);
+    }
+    else{
+        Heaps::DaryHeap<D> queue(dis);
+        settleFrom(g, queue, src, dst, dis, pre);
     }
 }
 /*
@@ -446,49 +927,45 @@ void GraphLib::Dijkstra(const Graph &g, size_t src, std::vector<int>& dis, std::
  property of the Upper bound of the shortest path to detect negative-weight cycles
  and find the shortest path between two vertices.
 */
-bool GraphLib::bellmanFord(const Graph &g, std::vector<int> &dis, std::vector<int> &pre, std::vector<int> &cycle) {
+template<typename W, typename D>
+bool GraphLib::bellmanFord(const BasicGraph<W, D> &g, std::vector<D> &dis, std::vector<int> &pre, std::vector<int> &cycle) {
     size_t len = g.getNumVertices();
     // vectors dis(distance) and pre(predecessor) were initialized before the function call
     // relax all the edges len-1 times, for the length of the largest shortest path
     for (size_t i = 0; i < len -1; i++) {
         for (size_t u = 0; u < len; u++) {
-            for (size_t v = 0; v < len; v++) {
-                if (g.getWeight(u,v) != NO_EDGE){
-                    if(!g.isDirected() && pre[u] == (int)v){
-                        continue;
-                    }
-                    // did not reach vertex u yet
-                    if(dis[u] == INT_MAX){
-                        continue;
-                    }
-                    // if u hav been reached try to relax the edge
-                    if(dis[u] != INT_MAX) { // && dis[u] + g.getWeight(u,v) < dis[v]
-                        relax(u, v, g.getWeight(u,v), dis, pre); // Use the relax function
-                    }
+            for (const auto &e : g.neighbours(u)) {
+                size_t v = e.to;
+                if(!g.isDirected() && pre[u] == (int)v){
+                    continue;
                 }
+                // did not reach vertex u yet
+                if(dis[u] == infinity<D>()){
+                    continue;
+                }
+                // if u hav been reached try to relax the edge
+                relax(u, v, e.weight, dis, pre); // Use the relax function
             }
         }
     }
     // all the vertices should have converged at this point
     // if we can relax an edge, then that edge is a part of a negative-weight cycle
     for (size_t u = 0; u < len-1; u++) {
-        for (size_t v = 0; v < len; v++) {
-            
-            if(g.getWeight(u,v) != NO_EDGE){
-                if(!g.isDirected() && pre[u] == (int)v){
-                    continue;
-                }
-                if(dis[u] == INT_MAX){
-                    continue;
-                }
-                if(dis[u] != INT_MAX && dis[u] + g.getWeight(u,v) < dis[v]) {
-                    
-                    pre[v] = u;
-                    cycle.push_back(u);
-                    cycle.push_back(pre[u]);
-                    return true; // Negative-weight cycle detected 
-                }      
+        for (const auto &e : g.neighbours(u)) {
+            size_t v = e.to;
+            if(!g.isDirected() && pre[u] == (int)v){
+                continue;
+            }
+            if(dis[u] == infinity<D>()){
+                continue;
             }
+            if(dis[u] + e.weight < dis[v]) {
+                
+                pre[v] = u;
+                cycle.push_back(u);
+                cycle.push_back(pre[u]);
+                return true; // Negative-weight cycle detected 
+            }      
         }
     }
     return false; // No negative-weight cycle detected
@@ -507,4 +984,15 @@ std::vector<int> GraphLib::parsePath(std::string path) {
     result.push_back(std::stoi(path));
     return result;  
 }
-    
\ No newline at end of file
+
+#define GRAPHLIB_INSTANTIATE_ALGORITHMS(W) \
+    template std::string GraphLib::Algorithms::isConnected(const GraphLib::BasicGraph<W> &g, Execution policy); \
+    template std::string GraphLib::Algorithms::shortestPath(const GraphLib::BasicGraph<W> &g, size_t src, size_t dst, Execution policy, Heap heap); \
+    template std::string GraphLib::Algorithms::isContainsCycle(const GraphLib::BasicGraph<W> &g); \
+    template std::string GraphLib::Algorithms::isBipartite(const GraphLib::BasicGraph<W> &g); \
+    template std::string GraphLib::Algorithms::negativeCycle(const GraphLib::BasicGraph<W> &g); \
+    template GraphLib::Algorithms::NearestSource<GraphLib::BasicGraph<W>::distance_type> \
+        GraphLib::Algorithms::multiSourceBFS(const GraphLib::BasicGraph<W> &g, const std::vector<size_t> &sources, Execution policy); \
+    template std::vector<std::vector<GraphLib::BasicGraph<W>::distance_type>> \
+        GraphLib::Algorithms::sourceDistances(const GraphLib::BasicGraph<W> &g, const std::vector<size_t> &sources);
+GRAPHLIB_FOR_EACH_WEIGHT(GRAPHLIB_INSTANTIATE_ALGORITHMS)
@@ -1,29 +1,65 @@
 
 #include <string>
+#include <vector>
 #include "Graph.hpp"
 
 namespace GraphLib{
         
         namespace Algorithms{
+                /**
+                 * @brief The execution policies of the searches, SEQUENTIAL runs on the calling thread and PARALLEL
+                 * @brief expands every large BFS level on all the hardware threads. Both give the result of a classic FIFO BFS.
+                **/
+                enum Execution{SEQUENTIAL, PARALLEL};
+
+                /**
+                 * @brief The priority queues of Dijkstra's algorithm. DARY_HEAP is an indexed 4-ary heap, PAIRING_HEAP a
+                 * @brief pairing heap with O(1) decrease key, RADIX_HEAP a radix heap over the bits of the integral
+                 * @brief distances and DIAL_BUCKETS Dial's circular array with a bucket per distance up to the largest
+                 * @brief weight, O(V + E + W) for integral weights up to W. AUTO_HEAP takes the buckets when the integral
+                 * @brief weights are at most 256 and the 4-ary heap otherwise. Floating point weights, and DIAL_BUCKETS for
+                 * @brief weights above 2^20, use the 4-ary heap instead. All give the same path.
+                **/
+                enum Heap{AUTO_HEAP, DARY_HEAP, PAIRING_HEAP, RADIX_HEAP, DIAL_BUCKETS};
+
+                /**
+                 * @struct NearestSource
+                 * @brief The result of a multi source BFS, for every vertex the number of edges to the nearest source
+                 * @brief (infinity<D>() if no source reaches it) and that source (-1 if none).
+                **/
+                template<typename D>
+                struct NearestSource {
+                        std::vector<D> dis;
+                        std::vector<int> owner;
+                };
+
                 /**
                  * @brief This function checks if the given graph is connected.
                  * @param g The graph to be checked.
+                 * @param policy Whether the BFS runs on the calling thread or on all the hardware threads.
                  * @return "The graph is connected." or "The graph is not connected.".
                  * @throws std::invalid_argument if the graph is not loaded.
                 **/
-               std::string isConnected(const Graph &g);
+               template<typename W, typename D>
+                std::string isConnected(const BasicGraph<W, D> &g, Execution policy = SEQUENTIAL);
                 
                 /**
                  * @brief This function find the shortest path between two vertices.
                  * @brief Vertices must be natural numbers given in the range [0, n-1] where n is the number of vertices.
+                 * @brief Dijkstra's algorithm stops once dst is settled, so only the predecessors on the path to dst
+                 * @brief are final, they are the ones a search that settles every vertex finds.
                  * @param g The graph to look for path on.
                  * @param src The source vertex.
                  * @param dst The destination vertex.
+                 * @param policy Whether the BFS of an unweighted graph runs on the calling thread or on all the hardware threads.
+                 * @param heap The priority queue of Dijkstra's algorithm for a graph without negative weights.
                  * @return The shortest path between the two vertices int the next
                         * format: "src->v1->v2->...->dst".
                  * @throws std::invalid_argument if the graph is not loaded.      
                 **/
-                std::string shortestPath(const Graph &g, size_t src, size_t dst);
+                template<typename W, typename D>
+                std::string shortestPath(const BasicGraph<W, D> &g, size_t src, size_t dst, Execution policy = SEQUENTIAL,
+                                         Heap heap = AUTO_HEAP);
 
                 /**
                  * @brief This function checks if the given graph contains a cycle.
@@ -31,7 +67,8 @@ namespace GraphLib{
                  * @return "There is no cycle in the graph" or "The cycle is: {cycle}"
                  * @throws std::invalid_argument if the graph is not loaded.
                 **/
-                std::string isContainsCycle(const Graph &g);
+                template<typename W, typename D>
+                std::string isContainsCycle(const BasicGraph<W, D> &g);
 
                 /**
                  * @brief This function checks if the given graph is Bipartite.
@@ -39,7 +76,8 @@ namespace GraphLib{
                  * @return The partition to sets of vertices A and B.
                  * @throws std::invalid_argument if the graph is not loaded.
                 **/
-                std::string isBipartite(const Graph &g);
+                template<typename W, typename D>
+                std::string isBipartite(const BasicGraph<W, D> &g);
 
                 /**
                  * @brief This function finds whether the graph contains a negative cycle.
@@ -49,7 +87,33 @@ namespace GraphLib{
                  * @return "There is no negative cycle in the graph" or "The negative cycle is: {cycle}
                  * @throws std::invalid_argument if the graph is not loaded.
                 **/
-                std::string negativeCycle(const Graph &g);
+                template<typename W, typename D>
+                std::string negativeCycle(const BasicGraph<W, D> &g);
+
+                /**
+                 * @brief This function finds the nearest source of every vertex in a single BFS that starts from all the
+                 * @brief sources at once, queued in ascending order. A vertex at the same distance from several sources
+                 * @brief gets the source of its parent that was queued first, so the result is deterministic.
+                 * @param g The graph to be traversed.
+                 * @param sources The source vertices, duplicates are ignored.
+                 * @param policy Whether the BFS runs on the calling thread or on all the hardware threads.
+                 * @return The distance to the nearest source and the nearest source of every vertex.
+                 * @throws std::invalid_argument if the graph is not loaded or a source is out of range.
+                **/
+                template<typename W, typename D>
+                NearestSource<D> multiSourceBFS(const BasicGraph<W, D> &g, const std::vector<size_t> &sources, Execution policy = SEQUENTIAL);
+
+                /**
+                 * @brief This function finds the distance from every source to every vertex. The sources are searched
+                 * @brief 64 at a time by a bit parallel BFS: every vertex keeps a word with a bit per source, so one
+                 * @brief pass over an edge moves the frontiers of all the 64 sources at once.
+                 * @param g The graph to be traversed.
+                 * @param sources The source vertices.
+                 * @return One vector per source with the number of edges to every vertex, infinity<D>() if it is not reached.
+                 * @throws std::invalid_argument if the graph is not loaded or a source is out of range.
+                **/
+                template<typename W, typename D>
+                std::vector<std::vector<D>> sourceDistances(const BasicGraph<W, D> &g, const std::vector<size_t> &sources);
 
         }
 }
\ No newline at end of file
@@ -0,0 +1,248 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "Kernels.hpp"
+#include "Semiring.hpp"
+#pragma once
+
+namespace GraphLib{
+
+        namespace Gemm{
+                // Register block of the micro kernel, MR rows of a by NR columns of b.
+                const size_t MR = 4;
+                const size_t NR = 16;
+                // Cache blocks, a MC x KC panel of a and a KC x NC panel of b are packed at a time.
+                const size_t MC = 64;
+                const size_t KC = 128;
+                const size_t NC = 512;
+                // Smaller matrices are multiplied on the calling thread only.
+                const size_t PARALLEL_MIN = 128;
+
+                /**
+                 * @return The number of threads to share out the given number of panels of an n x n product to.
+                **/
+                inline size_t threadCount(size_t n, size_t panels){
+                        return n < PARALLEL_MIN ? 1 : std::min<size_t>(panels, std::max(1u, std::thread::hardware_concurrency()));
+                }
+
+                /**
+                 * @brief Runs worker on the calling thread and on threads - 1 more threads and waits for all of them,
+                 * @brief the workers take their panels from a shared counter.
+                **/
+                template<typename F>
+                void runThreads(size_t threads, const F &worker){
+                        std::vector<std::thread> pool;
+                        for(size_t t = 1; t < threads; t++){
+                                pool.emplace_back(worker);
+                        }
+                        worker();
+                        for(size_t t = 0; t < pool.size(); t++){
+                                pool[t].join();
+                        }
+                }
+
+                /**
+                 * @brief Packs rows [i0, i0+mc) and columns [k0, k0+kc) of a into slivers of MR rows,
+                 * @brief stored column by column as D and padded with the semiring zero.
+                 * @return For every sliver, whether it holds a value other than zero, so empty slivers can be skipped.
+                **/
+                template<typename W, typename D, typename S>
+                void packA(const W *a, size_t lda, size_t i0, size_t mc, size_t k0, size_t kc, D *packed, std::vector<char> &used){
+                        used.assign((mc + MR - 1) / MR, 0);
+                        for(size_t s = 0; s * MR < mc; s++){
+                                D *dst = packed + s * MR * kc;
+                                for(size_t p = 0; p < kc; p++){
+                                        for(size_t r = 0; r < MR; r++){
+                                                size_t i = s * MR + r;
+                                                D value = i < mc ? S::load(a[(i0 + i) * lda + k0 + p]) : S::zero();
+                                                dst[p * MR + r] = value;
+                                                if(value != S::zero()){
+                                                        used[s] = 1;
+                                                }
+                                        }
+                                }
+                        }
+                }
+
+                /**
+                 * @brief Packs rows [k0, k0+kc) and columns [j0, j0+nc) of b into slivers of NR columns,
+                 * @brief stored row by row as D and padded with the semiring zero.
+                **/
+                template<typename W, typename D, typename S>
+                void packB(const W *b, size_t ldb, size_t k0, size_t kc, size_t j0, size_t nc, D *packed){
+                        for(size_t s = 0; s * NR < nc; s++){
+                                D *dst = packed + s * NR * kc;
+                                for(size_t p = 0; p < kc; p++){
+                                        const W *src = b + (k0 + p) * ldb + j0;
+                                        for(size_t c = 0; c < NR; c++){
+                                                size_t j = s * NR + c;
+                                                dst[p * NR + c] = j < nc ? S::load(src[j]) : S::zero();
+                                        }
+                                }
+                        }
+                }
+
+                /**
+                 * @brief The micro kernel, adds the product of an MR x kc sliver of a and a kc x NR sliver of b
+                 * @brief to an MR x NR block of c. Every row of the block is one vector of NR accumulators that
+                 * @brief stays in registers for the whole sliver.
+                **/
+                template<typename D, typename S>
+                inline __attribute__((always_inline))
+                void microKernel(size_t kc, const D *a, const D *b, D *c, size_t ldc){
+                        typedef D Row __attribute__((vector_size(NR * sizeof(D))));
+                        Row acc[MR];
+                        for(size_t r = 0; r < MR; r++){
+                                __builtin_memcpy(&acc[r], c + r * ldc, sizeof(Row));
+                        }
+                        for(size_t p = 0; p < kc; p++){
+                                Row bp;
+                                __builtin_memcpy(&bp, b + p * NR, sizeof(Row));
+                                for(size_t r = 0; r < MR; r++){
+                                        Row ar = Row() + a[p * MR + r];
+                                        S::multiplyAdd(acc[r], ar, bp);
+                                }
+                        }
+                        for(size_t r = 0; r < MR; r++){
+                                __builtin_memcpy(c + r * ldc, &acc[r], sizeof(Row));
+                        }
+                }
+
+                /**
+                 * @brief Computes rows [i0, i0+mc) of out = a * b, one NC wide tile at a time.
+                 * @brief The tile is accumulated in D over all the KC blocks and only then stored as W.
+                **/
+                template<typename W, typename D, typename S>
+                inline __attribute__((always_inline))
+                void multiplyPanel(const W *a, size_t lda, const W *b, size_t ldb, W *out, size_t ldc, size_t n, size_t i0, size_t mc,
+                                   std::vector<D> &packedA, std::vector<D> &packedB, std::vector<D> &tile, std::vector<char> &used){
+                        size_t mcPad = (mc + MR - 1) / MR * MR;
+                        for(size_t j0 = 0; j0 < n; j0 += NC){
+                                size_t nc = std::min(NC, n - j0);
+                                size_t ncPad = (nc + NR - 1) / NR * NR;
+                                std::fill(tile.begin(), tile.begin() + (std::ptrdiff_t)(mcPad * ncPad), S::zero());
+                                for(size_t k0 = 0; k0 < n; k0 += KC){
+                                        size_t kc = std::min(KC, n - k0);
+                                        packA<W, D, S>(a, lda, i0, mc, k0, kc, packedA.data(), used);
+                                        packB<W, D, S>(b, ldb, k0, kc, j0, nc, packedB.data());
+                                        for(size_t sa = 0; sa * MR < mc; sa++){
+                                                if(!used[sa]){
+                                                        continue;
+                                                }
+                                                for(size_t sb = 0; sb * NR < nc; sb++){
+                                                        microKernel<D, S>(kc, packedA.data() + sa * MR * kc, packedB.data() + sb * NR * kc,
+                                                                          tile.data() + sa * MR * ncPad + sb * NR, ncPad);
+                                                }
+                                        }
+                                }
+                                for(size_t i = 0; i < mc; i++){
+                                        W *dst = out + (i0 + i) * ldc + j0;
+                                        const D *src = tile.data() + i * ncPad;
+                                        for(size_t j = 0; j < nc; j++){
+                                                dst[j] = S::store(src[j]);
+                                        }
+                                }
+                        }
+                }
+
+                // The panel compiled once per instruction set, picked with the level of the elementwise kernels.
+                #define GRAPHLIB_GEMM_PANEL(NAME, ATTRIBUTES) \
+                template<typename W, typename D, typename S> \
+                ATTRIBUTES void NAME(const W *a, size_t lda, const W *b, size_t ldb, W *out, size_t ldc, size_t n, size_t i0, size_t mc, \
+                                     std::vector<D> &packedA, std::vector<D> &packedB, std::vector<D> &tile, std::vector<char> &used){ \
+                        multiplyPanel<W, D, S>(a, lda, b, ldb, out, ldc, n, i0, mc, packedA, packedB, tile, used); \
+                }
+                GRAPHLIB_GEMM_PANEL(panelScalar, )
+#if defined(__x86_64__) || defined(__i386__)
+                GRAPHLIB_GEMM_PANEL(panelSSE4, __attribute__((target("sse4.1"))))
+                GRAPHLIB_GEMM_PANEL(panelAVX2, __attribute__((target("avx2"))))
+                GRAPHLIB_GEMM_PANEL(panelAVX512, __attribute__((target("avx512f,avx512bw,avx512dq"))))
+#endif
+                #undef GRAPHLIB_GEMM_PANEL
+
+                /**
+                 * @brief Computes out = a * b over the semiring S for row-major n x n matrices.
+                 * @brief The rows of the result are split into panels of MC rows that are shared out to the
+                 * @brief hardware threads, every thread packs its own blocks so the threads never write the same memory.
+                 * @param a The left matrix, row i starts at a + i * lda.
+                 * @param b The right matrix, row i starts at b + i * ldb.
+                 * @param out The result, row i starts at out + i * ldc, it must not overlap a or b.
+                 * @param n The number of rows and columns.
+                **/
+                template<typename W, typename D, typename S>
+                void multiply(const W *a, size_t lda, const W *b, size_t ldb, W *out, size_t ldc, size_t n){
+                        typedef void (*Panel)(const W*, size_t, const W*, size_t, W*, size_t, size_t, size_t, size_t,
+                                              std::vector<D>&, std::vector<D>&, std::vector<D>&, std::vector<char>&);
+                        Panel panel = panelScalar<W, D, S>;
+#if defined(__x86_64__) || defined(__i386__)
+                        switch(Kernels::getLevel()){
+                                case Kernels::AVX512: panel = panelAVX512<W, D, S>; break;
+                                case Kernels::AVX2: panel = panelAVX2<W, D, S>; break;
+                                case Kernels::SSE4: panel = panelSSE4<W, D, S>; break;
+                                default: break;
+                        }
+#endif
+                        size_t panels = (n + MC - 1) / MC;
+                        std::atomic<size_t> next(0);
+                        auto worker = [&](){
+                                // the panels are padded to whole slivers
+                                std::vector<D> packedA((MC + MR - 1) / MR * MR * KC);
+                                std::vector<D> packedB((NC + NR - 1) / NR * NR * KC);
+                                std::vector<D> tile((MC + MR - 1) / MR * MR * ((NC + NR - 1) / NR * NR));
+                                std::vector<char> used;
+                                for(size_t p = next++; p < panels; p = next++){
+                                        size_t i0 = p * MC;
+                                        panel(a, lda, b, ldb, out, ldc, n, i0, std::min(MC, n - i0), packedA, packedB, tile, used);
+                                }
+                        };
+                        runThreads(threadCount(n, panels), worker);
+                }
+
+                /**
+                 * @brief Computes out = a * b over the semiring S for contiguous row-major n x n matrices.
+                **/
+                template<typename W, typename D, typename S>
+                void multiply(const W *a, const W *b, W *out, size_t n){
+                        multiply<W, D, S>(a, n, b, n, out, n, n);
+                }
+
+                /**
+                 * @brief Computes out = a * b with the ordinary addition and multiplication, accumulated in D.
+                **/
+                template<typename W, typename D>
+                void multiply(const W *a, const W *b, W *out, size_t n){
+                        multiply<W, D, PlusTimes<W, D>>(a, b, out, n);
+                }
+
+                /**
+                 * @brief The boolean product of n x n bit matrices with the given words per row,
+                 * @brief row i of out is the or of the rows k of b for every bit k set in row i of a.
+                 * @brief Panels of MC rows are shared out to the threads like the other products.
+                **/
+                inline void multiplyBits(const uint64_t *a, const uint64_t *b, uint64_t *out, size_t n, size_t words){
+                        size_t panels = (n + MC - 1) / MC;
+                        std::atomic<size_t> next(0);
+                        auto worker = [&](){
+                                for(size_t p = next++; p < panels; p = next++){
+                                        for(size_t i = p * MC; i < std::min(n, (p + 1) * MC); i++){
+                                                const uint64_t *row = a + i * words;
+                                                uint64_t *dst = out + i * words;
+                                                std::fill(dst, dst + words, 0ULL);
+                                                for(size_t w = 0; w < words; w++){
+                                                        for(uint64_t bits = row[w]; bits != 0; bits &= bits - 1){
+                                                                const uint64_t *src = b + ((w << 6) + (size_t)__builtin_ctzll(bits)) * words;
+                                                                for(size_t x = 0; x < words; x++){
+                                                                        dst[x] |= src[x];
+                                                                }
+                                                        }
+                                                }
+                                        }
+                                }
+                        };
+                        runThreads(threadCount(n, panels), worker);
+                }
+        }
+}
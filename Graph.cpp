@@ -1,23 +1,209 @@
 #include "Graph.hpp"
 #include <stdexcept>
+#include <algorithm>
+#include <utility>
+#include <functional>
+#include <cstring>
+#include "Gemm.hpp"
+#include "Strassen.hpp"
+
+namespace{
+    /*
+     A semiring applied to values that are already accumulators, so the intermediate powers are not loaded again
+     (a lightest walk of weight 0 must not become a missing one).
+    */
+    template<typename S, typename D>
+    struct Accumulated {
+        static D zero() {return S::zero();}
+        template<typename T> static void multiplyAdd(T &acc, const T &x, const T &y) {S::multiplyAdd(acc, x, y);}
+        static D load(D d) {return d;}
+        static D store(D d) {return d;}
+    };
+
+    // out = a * b for accumulator matrices, integral (+, *) products of large graphs use Strassen-Winograd
+    template<typename S, typename D>
+    void accumulatedProduct(const D *a, const D *b, D *out, size_t n, bool plusTimes){
+        if(plusTimes && GraphLib::Strassen::enabled<D>(n)){
+            GraphLib::Strassen::multiply<D, D>(a, b, out, n);
+        }
+        else{
+            GraphLib::Gemm::multiply<D, D, Accumulated<S, D>>(a, b, out, n);
+        }
+    }
+
+    /*
+     out = a * b modulo m for matrices with values in [0, m). b is split into its low and high 16 bits,
+     so both products stay below n * 2^32 * 2^16 <= 2^63 and are reduced before they are combined.
+    */
+    template<typename D>
+    void modularProduct(const D *a, const D *b, D *out, size_t n, D m, std::true_type){
+        size_t cells = n * n;
+        std::vector<D> low(cells), high(cells), lowProduct(cells), highProduct(cells);
+        for(size_t k = 0; k < cells; k++){
+            low[k] = b[k] & 0xFFFF;
+            high[k] = b[k] >> 16;
+        }
+        GraphLib::Gemm::multiply<D, D>(a, low.data(), lowProduct.data(), n);
+        GraphLib::Gemm::multiply<D, D>(a, high.data(), highProduct.data(), n);
+        for(size_t k = 0; k < cells; k++){
+            out[k] = (lowProduct[k] % m + ((highProduct[k] % m) << 16) % m) % m;
+        }
+    }
+
+    template<typename D>
+    void modularProduct(const D *, const D *, D *, size_t, D, std::false_type){
+        throw std::invalid_argument("The modulus is only defined for integral weights.");
+    }
+
+    // Brings a value into [0, m).
+    template<typename D>
+    D reduce(D value, D m, std::true_type){
+        value %= m;
+        return value < 0 ? value + m : value;
+    }
+
+    template<typename D>
+    D reduce(D value, D, std::false_type){
+        return value;
+    }
+
+    /*
+     Raises the matrix base to the power k by repeated squaring, base is squared once per bit of k
+     and used as scratch space. identity is returned when k is 0.
+    */
+    template<typename T, typename Product>
+    std::vector<T> powerBySquaring(std::vector<T> &base, std::vector<T> &&identity, size_t k, Product product){
+        std::vector<T> result(std::move(identity));
+        std::vector<T> temp(base.size());
+        bool first = true;
+        while(k > 0){
+            if(k & 1){
+                if(first){
+                    result = base;
+                    first = false;
+                }
+                else{
+                    product(result.data(), base.data(), temp.data());
+                    result.swap(temp);
+                }
+            }
+            k >>= 1;
+            if(k > 0){
+                product(base.data(), base.data(), temp.data());
+                base.swap(temp);
+            }
+        }
+        return result;
+    }
+
+    // The bases of the 2D rolling hash of subGraph, over the columns of a row and then over the rows.
+    const uint64_t ROW_BASE = 0x9E3779B97F4A7C15ULL;
+    const uint64_t COLUMN_BASE = 0xC2B2AE3D27D4EB4FULL;
+
+    // The hash of a single cell, equal values (0 and -0.0 included) hash the same and NO_EDGE hashes to 0.
+    template<typename W>
+    uint64_t cellHash(W value){
+        if(value == W(NO_EDGE)){
+            return 0;
+        }
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(W));
+        return (bits + 1) * 0xFF51AFD7ED558CCDULL;
+    }
+
+    // The splitmix64 finalizer, spreads every bit of x over the whole word.
+    inline uint64_t mix(uint64_t x){
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    /*
+     The hash of the edge (i, j) of the given weight. The hash of a graph is the sum of the hashes of its edges,
+     so it does not depend on the storage or on the number of vertices.
+    */
+    template<typename W>
+    uint64_t edgeHash(size_t i, size_t j, W weight){
+        return mix(mix((uint64_t)i * ROW_BASE + (uint64_t)j) + cellHash(weight));
+    }
+
+    /*
+     Rolls a window of the given width along a line of n hashes that are stride apart,
+     out[k * outStride] is the polynomial hash of the window starting at k, modulo 2^64.
+    */
+    void rollLine(const uint64_t *in, size_t stride, size_t n, size_t width, uint64_t base, uint64_t *out, size_t outStride){
+        uint64_t top = 1;
+        uint64_t hash = 0;
+        for(size_t k = 0; k < width; k++){
+            hash = hash * base + in[k * stride];
+            if(k > 0){
+                top *= base;
+            }
+        }
+        out[0] = hash;
+        for(size_t k = width; k < n; k++){
+            hash = (hash - in[(k - width) * stride] * top) * base + in[k * stride];
+            out[(k - width + 1) * outStride] = hash;
+        }
+    }
+
+    /*
+     The degree sketch of subGraph, the out degrees and in degrees of a graph sorted in descending order.
+     Row k of a submatrix is a part of some row of the graph, so the k-th largest out degree of a subgraph
+     is at most the k-th largest out degree of the graph, and the same holds for the in degrees.
+    */
+    template<typename G>
+    void degreeSketch(const G &g, std::vector<size_t> &out, std::vector<size_t> &in){
+        size_t len = g.getNumVertices();
+        out.assign(len, 0);
+        in.assign(len, 0);
+        for(size_t u = 0; u < len; u++){
+            for(const auto &edge : g.neighbours(u)){
+                out[u]++;
+                in[edge.to]++;
+            }
+        }
+        std::sort(out.begin(), out.end(), std::greater<size_t>());
+        std::sort(in.begin(), in.end(), std::greater<size_t>());
+    }
+
+    // Whether the k-th largest degree of the sketch small is at most the k-th largest of big for every k.
+    bool dominated(const std::vector<size_t> &small, const std::vector<size_t> &big){
+        for(size_t k = 0; k < small.size(); k++){
+            if(small[k] > big[k]){
+                return false;
+            }
+        }
+        return true;
+    }
+}
 
 // This is the class constructor, set all boolean flags to false
-GraphLib::Graph::Graph(){
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>::BasicGraph(){
+    vertices = 0;
+    words = 0;
+    storage = DENSE;
     directed = false;
     negValues = false;
     weighted = false;
     loaded = false;
+    keyValid = false;
+    countersValid = false;
+    heaviestValid = false;
 }
 
 // This is the class destructor
-GraphLib::Graph::~Graph(){}
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>::~BasicGraph(){}
 /*
  This method loads values to the adjacency matrix that represents the graph.
  It also sets the boolean flags that represent the graph properties.
  If the graph is not squared or empty then the function will throw an invalid argument exception.
  If the graph is already loaded then the function will override it.
  */
-void GraphLib::Graph::loadGraph(std::vector<std::vector<int>> mat){
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadGraph(const std::vector<std::vector<W>> &mat){
     this->clear();
     if(mat.empty()){
         throw std::invalid_argument("The given matrix is empty.");
@@ -29,55 +215,604 @@ void GraphLib::Graph::loadGraph(std::vector<std::vector<int>> mat){
         }
     }
     size_t len = mat.size();
-    bool flag = false;
-    for(const auto& innerVec : mat){
-        if( innerVec.size() != len){
-            this->adjTable.clear();
-        }
-        if(!this->isNegValues()){
-            for(const auto& element : innerVec){
-                if(!this->isNegValues()){
-                    if( element < 0){
-                        this->setNegValues();
-                        this->setWeighted();
-                        break;
-                    }
-                }
-                if(!this->isWeighted()){
-                    if(element > 1){
-                        this->setWeighted();
-                    }
-                }
+    Matrix flat(len * len);
+    for(size_t i = 0; i < len; i++){
+        std::copy(mat[i].begin(), mat[i].end(), flat.begin() + (std::ptrdiff_t)(i * len));
+    }
+    this->loadMatrix(len, std::move(flat));
+}
+
+/*
+ The same as loading a const matrix, but every row is freed once it was copied into the flat buffer.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadGraph(std::vector<std::vector<W>> &&mat){
+    this->clear();
+    if(mat.empty()){
+        throw std::invalid_argument("The given matrix is empty.");
+    }
+    //check if the given matrix is squared
+    for(size_t i = 0; i<mat.size();i++){
+        if(mat[i].size() != mat.size()){
+            throw std::invalid_argument("The given matrix is not squared.");
+        }
+    }
+    size_t len = mat.size();
+    Matrix flat(len * len);
+    for(size_t i = 0; i < len; i++){
+        std::copy(mat[i].begin(), mat[i].end(), flat.begin() + (std::ptrdiff_t)(i * len));
+        std::vector<W>().swap(mat[i]);
+    }
+    mat.clear();
+    this->loadMatrix(len, std::move(flat));
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadGraph(size_t len, Matrix &&mat){
+    this->clear();
+    if(len == 0){
+        throw std::invalid_argument("The given matrix is empty.");
+    }
+    if(mat.size() != len * len){
+        throw std::invalid_argument("The given matrix is not squared.");
+    }
+    this->loadMatrix(len, std::move(mat));
+}
+
+/*
+ This method takes ownership of a row-major len*len buffer and computes the flags in one pass.
+ The buffer is swapped in, so the given matrix is left empty.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadMatrix(size_t len, Matrix &&mat){
+    this->clear();
+    this->adjTable.assign(std::move(mat));
+    this->vertices = len;
+    this->setLoaded();
+    this->updateGraphFlags();
+    this->compact();
+}
+
+/*
+ The same as loading a buffer, but the flags were already computed by an elementwise kernel.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadMatrix(size_t len, Matrix &&mat, const Kernels::Flags &flags, bool symmetric){
+    this->clear();
+    this->adjTable.assign(std::move(mat));
+    this->vertices = len;
+    this->setLoaded();
+    this->setKernelFlags(flags, symmetric);
+    this->compact();
+}
+
+/*
+ This method takes ownership of a packed upper triangle computed by an elementwise kernel from packed operands,
+ which are symmetric, so the result is undirected.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadPacked(size_t len, Matrix &&mat, const Kernels::Flags &flags){
+    this->clear();
+    this->adjTable.assign(std::move(mat));
+    this->vertices = len;
+    this->storage = PACKED;
+    this->setLoaded();
+    this->setKernelFlags(flags, true);
+    this->compact();
+}
+
+/*
+ This method sets the flags computed by an elementwise kernel.
+ An elementwise operation on symmetric operands gives a symmetric matrix, so the symmetry is only
+ checked when one of the operands was directed.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::setKernelFlags(const Kernels::Flags &flags, bool symmetric){
+    this->negValues = flags.negValues;
+    this->weighted = flags.weighted;
+    this->directed = symmetric ? false : !this->isSymetric();
+    this->keyValid = false;
+    this->countersValid = false;
+    this->heaviestValid = false;
+}
+
+/*
+ This method loads a graph given in compressed sparse row form.
+ The representation is validated and the flags are computed from the stored edges only,
+ so loading costs O(V + E log(E/V)) and the matrix is never materialized.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::loadGraph(const CSR &mat){
+    this->clear();
+    if(mat.offsets.size() < 2){
+        throw std::invalid_argument("The given matrix is empty.");
+    }
+    size_t len = mat.offsets.size() - 1;
+    if(mat.offsets[0] != 0 || mat.offsets[len] != mat.cols.size() || mat.cols.size() != mat.weights.size()){
+        throw std::invalid_argument("The given sparse representation is malformed.");
+    }
+    for(size_t u = 0; u < len; u++){
+        if(mat.offsets[u] > mat.offsets[u + 1]){
+            throw std::invalid_argument("The given sparse representation is malformed.");
+        }
+        for(size_t k = mat.offsets[u]; k < mat.offsets[u + 1]; k++){
+            if(mat.cols[k] >= len || mat.weights[k] == NO_EDGE || (k > mat.offsets[u] && mat.cols[k] <= mat.cols[k - 1])){
+                throw std::invalid_argument("The given sparse representation is malformed.");
+            }
+            if(mat.weights[k] < 0){
+                this->setNegValues();
+                this->setWeighted();
+            }
+            else if(mat.weights[k] > 1){
+                this->setWeighted();
             }
         }
-        this->adjTable.push_back(innerVec);
     }
+    this->csr.assign(CSR(mat));
+    this->vertices = len;
+    this->storage = SPARSE;
+    this->setLoaded();
     if(!this->isSymetric()){
         this->setDirected();
     }
-    this->setLoaded();
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::toSparse(){
+    if(!this->isLoaded()){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    if(this->storage == SPARSE){
+        return;
+    }
+    this->csr.assign(this->getCSR());
+    this->adjTable.reset();
+    this->bitTable.reset();
+    this->storage = SPARSE;
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::toDense(){
+    if(!this->isLoaded()){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    if(this->storage == DENSE){
+        return;
+    }
+    Matrix flat;
+    this->denseData(flat);
+    this->adjTable.assign(std::move(flat));
+    this->csr.reset();
+    this->bitTable.reset();
+    this->storage = DENSE;
 }
 
 /*
- This method prints information about the graph.
+ This method packs a dense unweighted graph into one bit per cell.
+ Every row is padded to a whole number of 64 bit words and the padding bits are kept 0.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::toBitset(){
+    size_t len = this->vertices;
+    this->words = (len + 63) / 64;
+    std::vector<uint64_t> bits(len * this->words, 0);
+    for(size_t i = 0; i < len; i++){
+        const W *r = this->row(i);
+        uint64_t *bitRow = bits.data() + i * this->words;
+        for(size_t j = 0; j < len; j++){
+            if(r[j] != NO_EDGE){
+                bitRow[j >> 6] |= 1ULL << (j & 63);
+            }
+        }
+    }
+    this->bitTable.assign(std::move(bits));
+    this->adjTable.reset();
+    this->storage = BITSET;
+}
+
+/*
+ This method keeps only the upper triangle of a dense symmetric matrix, row i from its diagonal on,
+ so the graph takes about half the memory.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::toPacked(){
+    size_t len = this->vertices;
+    Matrix packed(len * (len + 1) / 2);
+    for(size_t i = 0; i < len; i++){
+        std::copy(this->row(i) + i, this->row(i) + len, packed.begin() + (std::ptrdiff_t)packedIndex(i, i, len));
+    }
+    this->adjTable.assign(std::move(packed));
+    this->storage = PACKED;
+}
+
+/*
+ This method picks the storage of a matrix after it was rewritten: bit rows for an unweighted graph,
+ the upper triangle for a weighted one that is symmetric. A sparse graph keeps its storage.
 */
-void GraphLib::Graph::printGraph(){
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::compact(){
+    if(this->storage == SPARSE || this->storage == BITSET){
+        return;
+    }
+    if(!this->weighted && !this->negValues){
+        this->toDense();
+        this->toBitset();
+    }
+    // the directed flag can be cleared on an asymmetric matrix (setUnDirected, or a kernel that trusted the flags
+    // of its operands), so only a matrix without asymmetric pairs is packed
+    else if(this->storage == DENSE && !this->directed && this->getCounters().asymmetric == 0){
+        this->toPacked();
+    }
+}
+
+template<typename W, typename D>
+typename GraphLib::BasicGraph<W, D>::CSR GraphLib::BasicGraph<W, D>::getCSR() const{
     if(!this->isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
     }
-    int edge_count = 0;
-    for(size_t i = 0; i<this->adjTable.size();i++){
-        for(size_t j = 0; j<this->adjTable[0].size();j++){
-            if(this->adjTable[i][j] != NO_EDGE){
-                edge_count++;
+    if(this->storage == SPARSE){
+        return *this->csr;
+    }
+    size_t len = this->vertices;
+    CSR result;
+    result.offsets.reserve(len + 1);
+    result.offsets.push_back(0);
+    for(size_t i = 0; i < len; i++){
+        for(const Edge &e : this->neighbours(i)){
+            result.cols.push_back(e.to);
+            result.weights.push_back(e.weight);
+        }
+        result.offsets.push_back(result.cols.size());
+    }
+    return result;
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::checkVertices(size_t u, size_t v) const{
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    if(u >= this->vertices || v >= this->vertices){
+        throw std::invalid_argument("The given vertices are out of range.");
+    }
+}
+
+/*
+ This method writes a single cell and updates the counters, the flags and the cached key from the old value,
+ the new value and the mirrored cell, which the write does not change unless it is on the diagonal.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::changeCell(size_t u, size_t v, W value){
+    W old = this->at(u, v);
+    if(old == value){
+        return;
+    }
+    if(this->storage == BITSET && value != NO_EDGE && value != static_cast<W>(1)){
+        this->toDense();
+    }
+    // a packed cell off the diagonal is also its mirror, the new value can not match the mirror any more
+    if(this->storage == PACKED && u != v){
+        this->toDense();
+    }
+    this->getCounters();
+    Counters &count = this->counters;
+    count.edges = count.edges + (value != NO_EDGE) - (old != NO_EDGE);
+    count.negative = count.negative + (value < 0) - (old < 0);
+    count.heavy = count.heavy + (value > 1) - (old > 1);
+    count.heaviest = std::max(count.heaviest, value);
+    if(u != v){
+        W mirror = this->at(v, u);
+        count.asymmetric = count.asymmetric + (value != mirror) - (old != mirror);
+    }
+    this->setCounterFlags();
+    if(this->keyValid){
+        this->key.edges = count.edges;
+        this->key.hash += (value != NO_EDGE ? edgeHash(u, v, value) : 0) - (old != NO_EDGE ? edgeHash(u, v, old) : 0);
+    }
+    if(this->storage == DENSE){
+        this->adjTable.write()[u * this->vertices + v] = value;
+    }
+    else if(this->storage == PACKED){
+        this->adjTable.write()[packedIndex(u, v, this->vertices)] = value;
+    }
+    else if(this->storage == BITSET){
+        uint64_t bit = 1ULL << (v & 63);
+        uint64_t &word = this->bitTable.write()[u * this->words + (v >> 6)];
+        word = value != NO_EDGE ? word | bit : word & ~bit;
+    }
+    else{
+        CSR &mat = this->csr.write();
+        std::vector<size_t> &cols = mat.cols;
+        std::vector<W> &weights = mat.weights;
+        auto first = cols.begin() + (std::ptrdiff_t)mat.offsets[u];
+        auto last = cols.begin() + (std::ptrdiff_t)mat.offsets[u + 1];
+        auto pos = std::lower_bound(first, last, v);
+        auto k = pos - cols.begin();
+        if(old != NO_EDGE && value != NO_EDGE){
+            weights[(size_t)k] = value;
+            return;
+        }
+        if(value != NO_EDGE){
+            cols.insert(pos, v);
+            weights.insert(weights.begin() + k, value);
+        }
+        else{
+            cols.erase(pos);
+            weights.erase(weights.begin() + k);
+        }
+        for(size_t r = u + 1; r <= this->vertices; r++){
+            mat.offsets[r] = value != NO_EDGE ? mat.offsets[r] + 1 : mat.offsets[r] - 1;
+        }
+    }
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::setEdge(size_t u, size_t v, W w){
+    this->checkVertices(u, v);
+    this->changeCell(u, v, w);
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::removeEdge(size_t u, size_t v){
+    this->checkVertices(u, v);
+    this->changeCell(u, v, static_cast<W>(NO_EDGE));
+}
+
+/*
+ The updates are stably sorted by cell and only the last update of every cell is kept, so applying the sorted
+ updates gives the same matrix as applying them in the given order, while the matrix is visited row after row.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::applyUpdates(const EdgeUpdate *updates, size_t count){
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    for(size_t k = 0; k < count; k++){
+        this->checkVertices(updates[k].from, updates[k].to);
+    }
+    std::vector<EdgeUpdate> sorted(updates, updates + count);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const EdgeUpdate &x, const EdgeUpdate &y){
+        return x.from != y.from ? x.from < y.from : x.to < y.to;
+    });
+    size_t last = 0;
+    for(size_t k = 0; k < sorted.size(); k++){
+        if(last > 0 && sorted[last - 1].from == sorted[k].from && sorted[last - 1].to == sorted[k].to){
+            sorted[last - 1] = sorted[k];
+        }
+        else{
+            sorted[last++] = sorted[k];
+        }
+    }
+    sorted.resize(last);
+    if(this->storage == SPARSE){
+        this->mergeSparse(sorted);
+        return;
+    }
+    for(size_t k = 0; k < sorted.size(); k++){
+        this->changeCell(sorted[k].from, sorted[k].to, sorted[k].weight);
+    }
+}
+
+/*
+ This method merges every CSR row with its sorted updates into new arrays in one pass.
+ The cached key is updated from the old and the new value of every updated cell,
+ the counters are counted again once at the end.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::mergeSparse(const std::vector<EdgeUpdate> &sorted){
+    size_t len = this->vertices;
+    const CSR &old = *this->csr;
+    CSR merged;
+    merged.offsets.resize(len + 1);
+    merged.cols.reserve(old.cols.size() + sorted.size());
+    merged.weights.reserve(old.cols.size() + sorted.size());
+    size_t k = 0;
+    for(size_t u = 0; u < len; u++){
+        merged.offsets[u] = merged.cols.size();
+        size_t p = old.offsets[u];
+        size_t end = old.offsets[u + 1];
+        while(p < end || (k < sorted.size() && sorted[k].from == u)){
+            if(k < sorted.size() && sorted[k].from == u && (p == end || sorted[k].to <= old.cols[p])){
+                const EdgeUpdate &update = sorted[k++];
+                W previous = static_cast<W>(NO_EDGE);
+                if(p < end && old.cols[p] == update.to){
+                    previous = old.weights[p++];
+                }
+                if(this->keyValid){
+                    this->key.edges = this->key.edges + (update.weight != NO_EDGE) - (previous != NO_EDGE);
+                    this->key.hash += (update.weight != NO_EDGE ? edgeHash(u, update.to, update.weight) : 0)
+                                    - (previous != NO_EDGE ? edgeHash(u, update.to, previous) : 0);
+                }
+                if(update.weight != NO_EDGE){
+                    merged.cols.push_back(update.to);
+                    merged.weights.push_back(update.weight);
+                }
+            }
+            else{
+                merged.cols.push_back(old.cols[p]);
+                merged.weights.push_back(old.weights[p]);
+                p++;
+            }
+        }
+    }
+    merged.offsets[len] = merged.cols.size();
+    this->csr.assign(std::move(merged));
+    this->updateGraphFlags();
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::setEdges(const std::vector<EdgeUpdate> &updates){
+    this->applyUpdates(updates.data(), updates.size());
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::removeEdges(const std::vector<std::pair<size_t, size_t>> &edges){
+    std::vector<EdgeUpdate> updates(edges.size());
+    for(size_t k = 0; k < edges.size(); k++){
+        updates[k] = EdgeUpdate{edges[k].first, edges[k].second, static_cast<W>(NO_EDGE)};
+    }
+    this->applyUpdates(updates.data(), updates.size());
+}
+
+template<typename W, typename D>
+size_t GraphLib::BasicGraph<W, D>::addVertex(){
+    return this->addVertices(1);
+}
+
+/*
+ This method adds vertices without edges, so the counters, the flags and the key stay the same.
+ A sparse graph appends empty rows, a bitset graph appends zero bit rows while the rows keep their number of words
+ and is laid out again otherwise, a dense matrix or a packed triangle is copied row by row into the larger one.
+*/
+template<typename W, typename D>
+size_t GraphLib::BasicGraph<W, D>::addVertices(size_t count){
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    size_t len = this->vertices;
+    size_t grown = len + count;
+    if(this->storage == SPARSE){
+        CSR &mat = this->csr.write();
+        mat.offsets.resize(grown + 1, mat.offsets[len]);
+    }
+    else if(this->storage == BITSET){
+        size_t rowWords = (grown + 63) / 64;
+        if(rowWords == this->words){
+            this->bitTable.write().resize(grown * rowWords, 0);
+        }
+        else{
+            std::vector<uint64_t> bits(grown * rowWords, 0);
+            for(size_t i = 0; i < len; i++){
+                std::copy(this->bitTable->begin() + (std::ptrdiff_t)(i * this->words),
+                          this->bitTable->begin() + (std::ptrdiff_t)((i + 1) * this->words),
+                          bits.begin() + (std::ptrdiff_t)(i * rowWords));
+            }
+            this->bitTable.assign(std::move(bits));
+            this->words = rowWords;
+        }
+    }
+    else if(this->storage == PACKED){
+        Matrix packed(grown * (grown + 1) / 2, static_cast<W>(NO_EDGE));
+        for(size_t i = 0; i < len; i++){
+            std::copy(this->adjTable->begin() + (std::ptrdiff_t)packedIndex(i, i, len),
+                      this->adjTable->begin() + (std::ptrdiff_t)packedIndex(i, len - 1, len) + 1,
+                      packed.begin() + (std::ptrdiff_t)packedIndex(i, i, grown));
+        }
+        this->adjTable.assign(std::move(packed));
+    }
+    else{
+        Matrix mat(grown * grown, static_cast<W>(NO_EDGE));
+        for(size_t i = 0; i < len; i++){
+            std::copy(this->row(i), this->row(i) + len, mat.begin() + (std::ptrdiff_t)(i * grown));
+        }
+        this->adjTable.assign(std::move(mat));
+    }
+    this->vertices = grown;
+    return len;
+}
+
+template<typename W, typename D>
+std::vector<std::vector<W>> GraphLib::BasicGraph<W, D>::getGraph() const{
+    size_t len = this->vertices;
+    std::vector<std::vector<W>> result(len, std::vector<W>(len, NO_EDGE));
+    if(this->storage == DENSE){
+        for(size_t i = 0; i < len; i++){
+            std::copy(this->row(i), this->row(i) + len, result[i].begin());
+        }
+        return result;
+    }
+    for(size_t u = 0; u < len; u++){
+        for(const Edge &e : this->neighbours(u)){
+            result[u][e.to] = e.weight;
+        }
+    }
+    return result;
+}
+
+/*
+ Returns a pointer to the row-major matrix of the graph, a sparse, bitset or packed graph is expanded into the given buffer.
+*/
+template<typename W, typename D>
+const W* GraphLib::BasicGraph<W, D>::denseData(Matrix &buffer) const{
+    if(this->storage == DENSE){
+        return this->adjTable->data();
+    }
+    size_t len = this->vertices;
+    if(this->storage == PACKED){
+        buffer.resize(len * len);
+        const W *packed = this->adjTable->data();
+        for(size_t i = 0; i < len; i++){
+            for(size_t j = i; j < len; j++){
+                buffer[i * len + j] = buffer[j * len + i] = *packed++;
             }
         }
+        return buffer.data();
+    }
+    buffer.assign(len * len, NO_EDGE);
+    for(size_t u = 0; u < len; u++){
+        for(const Edge &e : this->neighbours(u)){
+            buffer[u * len + e.to] = e.weight;
+        }
     }
+    return buffer.data();
+}
+
+/*
+ Returns a pointer to the bit rows of the graph (a bit is set for every edge), a dense or sparse graph
+ is packed into the given buffer.
+*/
+template<typename W, typename D>
+const uint64_t* GraphLib::BasicGraph<W, D>::bitData(std::vector<uint64_t> &buffer) const{
+    if(this->storage == BITSET){
+        return this->bitTable->data();
+    }
+    size_t len = this->vertices;
+    size_t rowWords = (len + 63) / 64;
+    buffer.assign(len * rowWords, 0);
+    for(size_t u = 0; u < len; u++){
+        for(const Edge &e : this->neighbours(u)){
+            buffer[u * rowWords + (e.to >> 6)] |= 1ULL << (e.to & 63);
+        }
+    }
+    return buffer.data();
+}
+
+// Binary search for column j inside the sorted CSR row of vertex i.
+template<typename W, typename D>
+W GraphLib::BasicGraph<W, D>::sparseWeight(size_t i, size_t j) const{
+    const CSR &mat = *this->csr;
+    size_t lo = mat.offsets[i];
+    size_t hi = mat.offsets[i + 1];
+    while(lo < hi){
+        size_t mid = lo + (hi - lo) / 2;
+        if(mat.cols[mid] < j){
+            lo = mid + 1;
+        }
+        else{
+            hi = mid;
+        }
+    }
+    if(lo < mat.offsets[i + 1] && mat.cols[lo] == j){
+        return mat.weights[lo];
+    }
+    return NO_EDGE;
+}
+
+/*
+ This method prints information about the graph.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::printGraph(){
+    if(!this->isLoaded()){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    int edge_count = this->countEdges();
+    size_t len = this->getNumVertices();
     std::string result = "This is a";
     if(this->isDirected()){
-        result += " directed graph with " + std::to_string(this->adjTable.size()) + " vertices and " + std::to_string(edge_count) + " edges.";
+        result += " directed graph with " + std::to_string(len) + " vertices and " + std::to_string(edge_count) + " edges.";
     }else{
-        result += "n undirected graph with " + std::to_string(this->adjTable.size()) + " vertices and " + std::to_string(edge_count/2) + " edges.";
+        result += "n undirected graph with " + std::to_string(len) + " vertices and " + std::to_string(edge_count/2) + " edges.";
     }
     
     std::cout << result << std::endl;
@@ -86,11 +821,37 @@ void GraphLib::Graph::printGraph(){
 /*
  This method checks whether the matrix that represents the graph is symmetric or not.
 */
-bool GraphLib::Graph::isSymetric(){
-    for(size_t i = 0; i<this->adjTable.size();i++){
-        for(size_t j = 0; j<this->adjTable[0].size();j++){
-            if(this->adjTable[i][j] != this->adjTable[j][i]){
-                return false;
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::isSymetric(){
+    if(this->storage == PACKED){
+        return true;
+    }
+    if(this->storage != DENSE){
+        // every stored edge needs a mirrored edge with the same weight
+        for(size_t u = 0; u < this->vertices; u++){
+            for(const Edge &e : this->neighbours(u)){
+                if(this->at(e.to, u) != e.weight){
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    // compare the upper triangle against the lower one tile by tile,
+    // so the transposed reads stay inside a few cache lines
+    const size_t TILE = 64;
+    size_t len = this->vertices;
+    const W *mat = this->adjTable->data();
+    for(size_t ib = 0; ib < len; ib += TILE){
+        for(size_t jb = ib; jb < len; jb += TILE){
+            size_t iEnd = std::min(ib + TILE, len);
+            size_t jEnd = std::min(jb + TILE, len);
+            for(size_t i = ib; i < iEnd; i++){
+                for(size_t j = std::max(jb, i + 1); j < jEnd; j++){
+                    if(mat[i * len + j] != mat[j * len + i]){
+                        return false;
+                    }
+                }
             }
         }
     }
@@ -98,93 +859,277 @@ bool GraphLib::Graph::isSymetric(){
 
 }
 
-void GraphLib::Graph::copyFlags(const GraphLib::Graph &g){
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::copyFlags(const GraphLib::BasicGraph<W, D> &g){
     this->directed = g.isDirected();
     this->negValues = g.isNegValues();
     this->weighted = g.isWeighted();
     this->loaded = g.isLoaded();
+    this->key = g.key;
+    this->keyValid = g.keyValid.load();
+    this->counters = g.counters;
+    this->countersValid = g.countersValid.load();
+    this->heaviest = g.heaviest;
+    this->heaviestValid = g.heaviestValid.load();
 }
 
-void GraphLib::Graph::updateGraphFlags()
+/*
+ The flags are derived from the counters, which are recounted in a single pass.
+*/
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::updateGraphFlags()
 {
-    this->directed = !this->isSymetric();
-    this->negValues = false;
-    this->weighted = false;
-    for(size_t i = 0; i < this->getNumVertices(); i++){
-        for(size_t j = 0; j < this->getNumVertices(); j++){
-            if(this->adjTable[i][j] < 0){
-                this->setNegValues();
-                this->setWeighted();
-                return;
+    this->countersValid = false;
+    this->heaviestValid = false;
+    this->getCounters();
+    this->setCounterFlags();
+}
+
+template<typename W, typename D>
+void GraphLib::BasicGraph<W, D>::setCounterFlags(){
+    this->directed = this->counters.asymmetric > 0;
+    this->negValues = this->counters.negative > 0;
+    this->weighted = this->counters.negative > 0 || this->counters.heavy > 0;
+}
+
+/*
+ This method counts the edges, the negative entries, the entries greater than 1 and the asymmetric pairs,
+ and finds the largest entry.
+ A dense matrix is read once, tile against mirrored tile like isSymetric, so every pair (i, j), (j, i) is counted
+ from a single visit. A sparse or bitset graph counts its stored edges, a pair is asymmetric if the mirrored
+ entry differs, checked from the lower endpoint when both edges exist and from the existing edge otherwise.
+ A packed triangle counts every entry off the diagonal for both of its cells.
+ Like the ordering key, the counters are computed under the cache lock.
+*/
+template<typename W, typename D>
+const typename GraphLib::BasicGraph<W, D>::Counters& GraphLib::BasicGraph<W, D>::getCounters() const{
+    if(this->countersValid.load(std::memory_order_acquire)){
+        return this->counters;
+    }
+    std::lock_guard<std::mutex> lock(this->cacheLock);
+    if(this->countersValid.load(std::memory_order_relaxed)){
+        return this->counters;
+    }
+    Counters count = {0, 0, 0, 0, static_cast<W>(NO_EDGE)};
+    auto add = [&count](W value){
+        count.edges += value != NO_EDGE;
+        count.negative += value < 0;
+        count.heavy += value > 1;
+        count.heaviest = std::max(count.heaviest, value);
+    };
+    size_t len = this->vertices;
+    if(this->storage == PACKED){
+        const W *packed = this->adjTable->data();
+        for(size_t i = 0; i < len; i++){
+            add(*packed++);
+            for(size_t j = i + 1; j < len; j++){
+                W value = *packed++;
+                add(value);
+                add(value);
             }
-            if(this->adjTable[i][j] > 1){
-                this->setWeighted();
+        }
+    }
+    else if(this->storage != DENSE){
+        for(size_t u = 0; u < len; u++){
+            for(const Edge &e : this->neighbours(u)){
+                add(e.weight);
+                if(e.to == u){
+                    continue;
+                }
+                W mirror = this->at(e.to, u);
+                if(u < e.to ? mirror != e.weight : mirror == NO_EDGE){
+                    count.asymmetric++;
+                }
+            }
+        }
+    }
+    else{
+        const size_t TILE = 64;
+        const W *mat = this->adjTable->data();
+        for(size_t ib = 0; ib < len; ib += TILE){
+            for(size_t jb = ib; jb < len; jb += TILE){
+                size_t iEnd = std::min(ib + TILE, len);
+                size_t jEnd = std::min(jb + TILE, len);
+                for(size_t i = ib; i < iEnd; i++){
+                    if(jb == ib){
+                        add(mat[i * len + i]);
+                    }
+                    for(size_t j = std::max(jb, i + 1); j < jEnd; j++){
+                        W x = mat[i * len + j];
+                        W y = mat[j * len + i];
+                        add(x);
+                        add(y);
+                        count.asymmetric += x != y;
+                    }
+                }
+            }
+        }
+    }
+    this->counters = count;
+    this->countersValid.store(true, std::memory_order_release);
+    return this->counters;
+}
+
+/*
+ The bound kept with the counters when they are cached. Otherwise the largest stored weight is found in one pass
+ over the edges, a packed triangle read in place, and kept until the counters are dropped with the matrix, so later
+ calls do not read the edges again. Like the counters, it is computed under the cache lock.
+*/
+template<typename W, typename D>
+W GraphLib::BasicGraph<W, D>::maxWeightBound() const{
+    if(this->countersValid.load(std::memory_order_acquire)){
+        return this->counters.heaviest;
+    }
+    if(this->heaviestValid.load(std::memory_order_acquire)){
+        return this->heaviest;
+    }
+    std::lock_guard<std::mutex> lock(this->cacheLock);
+    if(this->heaviestValid.load(std::memory_order_relaxed)){
+        return this->heaviest;
+    }
+    W found = static_cast<W>(NO_EDGE);
+    if(this->storage == PACKED){
+        const W *packed = this->adjTable->data();
+        for(size_t k = 0; k < this->vertices * (this->vertices + 1) / 2; k++){
+            found = std::max(found, packed[k]);
+        }
+    }
+    else{
+        for(size_t u = 0; u < this->vertices; u++){
+            for(const Edge &e : this->neighbours(u)){
+                found = std::max(found, e.weight);
             }
         }
     }
+    this->heaviest = found;
+    this->heaviestValid.store(true, std::memory_order_release);
+    return this->heaviest;
 }
 
-bool GraphLib::Graph::subGraph(const GraphLib::Graph &g) const
+/*
+ This method checks if the current graph appears as a block of the adjacency matrix of the given graph.
+ Graphs that have more edges, or a degree the given graph can not hold, are rejected without reading the matrices.
+ Otherwise every block is found by a 2D rolling hash: the hash of every window of n1 columns of every row,
+ then the hash of every n1 of those row hashes over the rows, in O(n2^2) time in total.
+ Only the blocks whose hash equals the hash of the current graph are compared cell by cell.
+*/
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::subGraph(const GraphLib::BasicGraph<W, D> &g) const
 {
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
     size_t vxs1 = this->getNumVertices();
     size_t vxs2 = g.getNumVertices();
-    if(vxs1 > vxs2){
+    if(vxs1 > vxs2 || this->countEdges() > g.countEdges()){
+        return false;
+    }
+    std::vector<size_t> out1, in1, out2, in2;
+    degreeSketch(*this, out1, in1);
+    degreeSketch(g, out2, in2);
+    if(!dominated(out1, out2) || !dominated(in1, in2)){
         return false;
     }
-    for(size_t i = 0; i<= vxs2 - vxs1; i++){
-        for(size_t j = 0; j<= vxs2 - vxs1; j++){
+    Matrix buffer1, buffer2;
+    const W *pattern = this->denseData(buffer1);
+    const W *text = g.denseData(buffer2);
+    size_t offsets = vxs2 - vxs1 + 1;
+    std::vector<uint64_t> line(vxs2);
+    // the hash of the current graph
+    std::vector<uint64_t> patternRows(vxs1);
+    for(size_t k = 0; k < vxs1; k++){
+        for(size_t l = 0; l < vxs1; l++){
+            line[l] = cellHash(pattern[k * vxs1 + l]);
+        }
+        rollLine(line.data(), 1, vxs1, vxs1, ROW_BASE, &patternRows[k], 1);
+    }
+    uint64_t target = 0;
+    rollLine(patternRows.data(), 1, vxs1, vxs1, COLUMN_BASE, &target, 1);
+    // the hashes of all the windows of vxs1 columns, one row of offsets per row of g
+    std::vector<uint64_t> rowHashes(vxs2 * offsets);
+    for(size_t i = 0; i < vxs2; i++){
+        for(size_t j = 0; j < vxs2; j++){
+            line[j] = cellHash(text[i * vxs2 + j]);
+        }
+        rollLine(line.data(), 1, vxs2, vxs1, ROW_BASE, rowHashes.data() + i * offsets, 1);
+    }
+    std::vector<uint64_t> blockHashes(offsets);
+    for(size_t j = 0; j < offsets; j++){
+        rollLine(rowHashes.data() + j, offsets, vxs2, vxs1, COLUMN_BASE, blockHashes.data(), 1);
+        for(size_t i = 0; i < offsets; i++){
+            if(blockHashes[i] != target){
+                continue;
+            }
             bool finished = true;
-            for(size_t k = 0; k < vxs1; k++){
+            for(size_t k = 0; k < vxs1 && finished; k++){
+                const W *block = text + (i + k) * vxs2 + j;
+                const W *source = pattern + k * vxs1;
                 for(size_t l = 0; l < vxs1; l++){
-                    if(this->adjTable[k][l] != g.getWeight(i + k, j + l)){
+                    if(source[l] != block[l]){
                         finished = false;
                         break;
                     }
                 }
-                if(!finished){
-                    break;
-                }
             }
             if(finished){
                 return true;
             }
         }
     }
-    return true;
+    return false;
 }
 
-int GraphLib::Graph::countEdges() const
+template<typename W, typename D>
+int GraphLib::BasicGraph<W, D>::countEdges() const
 {
     if(!this->loaded){
         throw std::invalid_argument("The graph is not loaded.");
     }
-    size_t len = this->getNumVertices();
-    int edge_count = 0;
-    for(size_t i = 0; i<len; i++){
-        for(size_t j = 0; j<len; j++){
-            if(this->adjTable[i][j] != NO_EDGE){
-                edge_count++;
-            }
-        }
+    if(this->storage == SPARSE){
+        return (int)this->csr->cols.size();
     }
-    return edge_count;
+    return (int)this->getCounters().edges;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator=(const GraphLib::Graph &g)
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator=(const GraphLib::BasicGraph<W, D> &g)
 {
     if(!g.isLoaded()){
         throw std::invalid_argument("The assigning graph is not loaded.");
     }
-    this->adjTable = g.getGraph();
+    this->adjTable = g.adjTable;
+    this->csr = g.csr;
+    this->bitTable = g.bitTable;
+    this->vertices = g.vertices;
+    this->words = g.words;
+    this->storage = g.storage;
+    this->copyFlags(g);
+    return *this;
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator=(GraphLib::BasicGraph<W, D> &&g)
+{
+    if(!g.isLoaded()){
+        throw std::invalid_argument("The assigning graph is not loaded.");
+    }
+    if(this == &g){
+        return *this;
+    }
+    this->adjTable = std::move(g.adjTable);
+    this->csr = std::move(g.csr);
+    this->bitTable = std::move(g.bitTable);
+    this->vertices = g.vertices;
+    this->words = g.words;
+    this->storage = g.storage;
     this->copyFlags(g);
+    g.clear();
     return *this;
 }
 
 
-GraphLib::Graph GraphLib::Graph::operator+(const GraphLib::Graph &g) const{
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator+(const GraphLib::BasicGraph<W, D> &g) const &{
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
@@ -193,60 +1138,89 @@ GraphLib::Graph GraphLib::Graph::operator+(const GraphLib::Graph &g) const{
     if(vxs1 != vxs2){
         throw std::invalid_argument("The given graph has different size.");
     }
-    GraphLib::Graph result;
-    std::vector<std::vector<int>> temp;
-    for(size_t i = 0; i<vxs1; i++){
-        std::vector<int> innerVec;
-        for(size_t j = 0; j<vxs2; j++){
-            innerVec.push_back(this->adjTable[i][j] + g.getWeight(i, j));
-        }
-        temp.push_back(innerVec);
+    // two packed operands are symmetric, so every pair of cells is computed once from the upper triangles
+    bool packed = this->storage == PACKED && g.storage == PACKED;
+    Matrix bufA, bufB;
+    const W *a = packed ? this->adjTable->data() : this->denseData(bufA);
+    const W *b = packed ? g.adjTable->data() : g.denseData(bufB);
+    size_t cells = packed ? this->adjTable->size() : vxs1 * vxs1;
+    Matrix temp(cells);
+    Kernels::Flags flags = Kernels::apply(Kernels::ADD, a, b, temp.data(), cells);
+    BasicGraph result;
+    if(packed){
+        result.loadPacked(vxs1, std::move(temp), flags);
+    }
+    else{
+        result.loadMatrix(vxs1, std::move(temp), flags, !this->directed && !g.directed);
     }
-    result.loadGraph(temp);
-    result.updateGraphFlags();
     return result;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator+=(const GraphLib::Graph &g){
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator+=(const GraphLib::BasicGraph<W, D> &g){
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
     if(this->getNumVertices() != g.getNumVertices()){
         throw std::invalid_argument("The given graph has different size.");
     }
-    *this = this->operator+(g);
-    this->updateGraphFlags();
+    bool symmetric = !this->directed && !g.directed;
+    Matrix buf;
+    const W *b;
+    if(this->storage == PACKED && g.storage == PACKED){
+        b = g.adjTable->data();
+    }
+    else{
+        this->toDense();
+        b = g.denseData(buf);
+    }
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    this->setKernelFlags(Kernels::apply(Kernels::ADD, a, b, a, mat.size()), symmetric);
+    this->compact();
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator++(int)
+// the temporary left operand is updated in place and moved into the result
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator+(const GraphLib::BasicGraph<W, D> &g) &&{
+    *this += g;
+    return std::move(*this);
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator++(int)
 {
-    Graph temp = *this;
-    size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        for(size_t j = 0; j<len; j++){
-            this->adjTable[i][j]++;
-        }
+    BasicGraph temp = *this;
+    if(this->storage != PACKED){
+        this->toDense();
     }
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    Kernels::Flags flags = Kernels::apply(Kernels::ADD, a, static_cast<W>(1), a, mat.size());
     temp.copyFlags(*this);
-    this->updateGraphFlags();
+    this->setKernelFlags(flags, !this->directed);
     this->negValues = false;
+    this->compact();
     return temp;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator++()
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator++()
 {
-    size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        for(size_t j = 0; j<len; j++){
-            this->adjTable[i][j]++;
-        }
+    if(this->storage != PACKED){
+        this->toDense();
     }
-    this->updateGraphFlags();
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    Kernels::Flags flags = Kernels::apply(Kernels::ADD, a, static_cast<W>(1), a, mat.size());
+    this->setKernelFlags(flags, !this->directed);
+    this->compact();
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator+() const
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator+() const
 {
     if (!this->loaded)
     {
@@ -255,7 +1229,8 @@ GraphLib::Graph GraphLib::Graph::operator+() const
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator-(const GraphLib::Graph &g) const{
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator-(const GraphLib::BasicGraph<W, D> &g) const &{
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
@@ -264,21 +1239,26 @@ GraphLib::Graph GraphLib::Graph::operator-(const GraphLib::Graph &g) const{
     if(vxs1 != vxs2){
         throw std::invalid_argument("The given graph has different size.");
     }
-    GraphLib::Graph result;
-    std::vector<std::vector<int>> temp;
-    for(size_t i = 0; i<this->adjTable.size();i++){
-        std::vector<int> innerVec;
-        for(size_t j = 0; j<this->adjTable[0].size();j++){
-            innerVec.push_back(this->adjTable[i][j] - g.getWeight(i, j));
-        }
-        temp.push_back(innerVec);
+    // two packed operands are symmetric, so every pair of cells is computed once from the upper triangles
+    bool packed = this->storage == PACKED && g.storage == PACKED;
+    Matrix bufA, bufB;
+    const W *a = packed ? this->adjTable->data() : this->denseData(bufA);
+    const W *b = packed ? g.adjTable->data() : g.denseData(bufB);
+    size_t cells = packed ? this->adjTable->size() : vxs1 * vxs1;
+    Matrix temp(cells);
+    Kernels::Flags flags = Kernels::apply(Kernels::SUB, a, b, temp.data(), cells);
+    BasicGraph result;
+    if(packed){
+        result.loadPacked(vxs1, std::move(temp), flags);
+    }
+    else{
+        result.loadMatrix(vxs1, std::move(temp), flags, !this->directed && !g.directed);
     }
-    result.loadGraph(temp);
-    result.updateGraphFlags();
     return result;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator-=(const GraphLib::Graph &g){
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator-=(const GraphLib::BasicGraph<W, D> &g){
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
@@ -287,118 +1267,170 @@ GraphLib::Graph& GraphLib::Graph::operator-=(const GraphLib::Graph &g){
     if(vxs1 != vxs2){
         throw std::invalid_argument("The given graph has different size.");
     }
-    *this = this->operator-(g);
-    this->updateGraphFlags();
+    bool symmetric = !this->directed && !g.directed;
+    Matrix buf;
+    const W *b;
+    if(this->storage == PACKED && g.storage == PACKED){
+        b = g.adjTable->data();
+    }
+    else{
+        this->toDense();
+        b = g.denseData(buf);
+    }
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    this->setKernelFlags(Kernels::apply(Kernels::SUB, a, b, a, mat.size()), symmetric);
+    this->compact();
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator--(int)
+// the temporary left operand is updated in place and moved into the result
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator-(const GraphLib::BasicGraph<W, D> &g) &&{
+    *this -= g;
+    return std::move(*this);
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator--(int)
 {
-    Graph temp = *this;
+    BasicGraph temp = *this;
     temp.copyFlags(*this);
-    size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        for(size_t j = 0; j<len; j++){
-            this->adjTable[i][j]--;
-        }
+    if(this->storage != PACKED){
+        this->toDense();
     }
-    this->updateGraphFlags();  
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    Kernels::Flags flags = Kernels::apply(Kernels::SUB, a, static_cast<W>(1), a, mat.size());
+    this->setKernelFlags(flags, !this->directed);
+    this->compact();
     return temp;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator--()
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator--()
 {
-    size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len;i ++){
-        for(size_t j = 0; j<len; j++){
-            this->adjTable[i][j]--;
-        }
+    if(this->storage != PACKED){
+        this->toDense();
     }
-    this->updateGraphFlags();
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    Kernels::Flags flags = Kernels::apply(Kernels::SUB, a, static_cast<W>(1), a, mat.size());
+    this->setKernelFlags(flags, !this->directed);
+    this->compact();
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator-() const
-{   
-    Graph temp = *this;
-    temp *= -1;
-    temp.updateGraphFlags();
-    return temp;
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator-() const &
+{
+    // written straight into a new matrix, instead of copying the shared storage and negating it in place
+    return *this * static_cast<W>(-1);
 }
 
-GraphLib::Graph GraphLib::Graph::operator*(int scalar) const{
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator-() &&
+{
+    *this *= static_cast<W>(-1);
+    return std::move(*this);
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator*(W scalar) const &{
     if(!this->loaded){
         throw std::invalid_argument("The graph is not loaded.");
     }
-    Graph result;
-    std::vector<std::vector<int>> temp;
+    // a packed graph is computed on its upper triangle only
+    bool packed = this->storage == PACKED;
+    Matrix buf;
+    const W *a = packed ? this->adjTable->data() : this->denseData(buf);
     size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        std::vector<int> innerVec;
-        for(size_t j = 0; j<len; j++){
-            innerVec.push_back(this->adjTable[i][j] * scalar);
-        }
-        temp.push_back(innerVec);
+    size_t cells = packed ? this->adjTable->size() : len * len;
+    Matrix temp(cells);
+    Kernels::Flags flags = Kernels::apply(Kernels::MUL, a, scalar, temp.data(), cells);
+    BasicGraph result;
+    if(packed){
+        result.loadPacked(len, std::move(temp), flags);
+    }
+    else{
+        result.loadMatrix(len, std::move(temp), flags, !this->directed);
     }
-    result.loadGraph(temp);
-    result.updateGraphFlags();
     return result;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator*=(int scalar){
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator*=(W scalar){
     if(!this->loaded){
         throw std::invalid_argument("The graph is not loaded.");
     }
-    size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        for(size_t j = 0; j<len; j++){
-            this->adjTable[i][j] *= scalar;
-        }
+    if(this->storage != PACKED){
+        this->toDense();
     }
-    this->updateGraphFlags();
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    this->setKernelFlags(Kernels::apply(Kernels::MUL, a, scalar, a, mat.size()), !this->directed);
+    this->compact();
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator/(int scalar) const{
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator*(W scalar) &&{
+    *this *= scalar;
+    return std::move(*this);
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator/(W scalar) const &{
     if(!this->loaded){
         throw std::invalid_argument("The graph is not loaded.");
     }
     if(scalar == 0){
         throw std::invalid_argument("The scalar value is zero.");
     }
-    Graph result;
-    std::vector<std::vector<int>> temp;
+    // a packed graph is computed on its upper triangle only
+    bool packed = this->storage == PACKED;
+    Matrix buf;
+    const W *a = packed ? this->adjTable->data() : this->denseData(buf);
     size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        std::vector<int> innerVec;
-        for(size_t j = 0; j<len; j++){
-            innerVec.push_back(this->adjTable[i][j] / scalar);
-        }
-        temp.push_back(innerVec);
+    size_t cells = packed ? this->adjTable->size() : len * len;
+    Matrix temp(cells);
+    Kernels::Flags flags = Kernels::apply(Kernels::DIV, a, scalar, temp.data(), cells);
+    BasicGraph result;
+    if(packed){
+        result.loadPacked(len, std::move(temp), flags);
+    }
+    else{
+        result.loadMatrix(len, std::move(temp), flags, !this->directed);
     }
-    result.loadGraph(temp);
-    result.updateGraphFlags();
     return result;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator/=(int scalar){
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator/=(W scalar){
     if(!this->loaded){
         throw std::invalid_argument("The graph is not loaded.");
     }
     if(scalar == 0){
         throw std::invalid_argument("The scalar value is zero.");
     }
-    size_t len = this->getNumVertices();
-    for(size_t i = 0; i<len; i++){
-        for(size_t j = 0; j<len; j++){
-            this->adjTable[i][j] /= scalar;
-        }
+    if(this->storage != PACKED){
+        this->toDense();
     }
-    this->updateGraphFlags();
+    Matrix &mat = this->adjTable.write();
+    W *a = mat.data();
+    this->setKernelFlags(Kernels::apply(Kernels::DIV, a, scalar, a, mat.size()), !this->directed);
+    this->compact();
     return *this;
 }
 
-GraphLib::Graph GraphLib::Graph::operator*(const GraphLib::Graph &g) const{
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator/(W scalar) &&{
+    *this /= scalar;
+    return std::move(*this);
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::operator*(const GraphLib::BasicGraph<W, D> &g) const{
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
@@ -407,25 +1439,27 @@ GraphLib::Graph GraphLib::Graph::operator*(const GraphLib::Graph &g) const{
     if(vxs1 != vxs2){
         throw std::invalid_argument("The given graph has different size.");
     }
-    GraphLib::Graph result;
-    std::vector<std::vector<int>> temp (vxs1, std::vector<int>(vxs1, NO_EDGE));
-    for(size_t i = 0; i<vxs1; i++){
-        for(size_t j = 0; j<vxs1; j++){
-            int sum = 0;
-            for(size_t k = 0; k<vxs1;k++){
-                temp[i][j] += this->adjTable[i][k] * g.getWeight(k, j);
-            }
-        }
+    Matrix bufA, bufB;
+    const W *a = this->denseData(bufA);
+    const W *b = g.denseData(bufB);
+    Matrix temp(vxs1 * vxs1);
+    // large integral products recurse with Strassen-Winograd down to the tiled and packed product,
+    // both accumulate in D so the sums can not overflow W
+    if(Strassen::enabled<W>(vxs1)){
+        Strassen::multiply<W, D>(a, b, temp.data(), vxs1);
+    }
+    else{
+        Gemm::multiply<W, D>(a, b, temp.data(), vxs1);
     }
-    result.loadGraph(temp);
-    result.updateGraphFlags();
+    BasicGraph result;
+    result.loadMatrix(vxs1, std::move(temp));
     return result;
 }
 
-GraphLib::Graph& GraphLib::Graph::operator*=(const GraphLib::Graph &g){
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D>& GraphLib::BasicGraph<W, D>::operator*=(const GraphLib::BasicGraph<W, D> &g){
     try{
         *this = this->operator*(g);
-        this->updateGraphFlags();
         return *this;
     }
     catch(const std::invalid_argument &e){
@@ -433,7 +1467,157 @@ GraphLib::Graph& GraphLib::Graph::operator*=(const GraphLib::Graph &g){
     }
 }
 
-bool GraphLib::Graph::operator==(const GraphLib::Graph &g) const{
+/*
+ The (+, *) semiring is the ordinary product, the (or, and) semiring ors whole bit rows,
+ every other semiring runs the tiled product with its own kernel.
+*/
+template<typename W, typename D>
+template<template<typename, typename> class S>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::multiply(const GraphLib::BasicGraph<W, D> &g) const{
+    if(std::is_same<S<W, D>, PlusTimes<W, D>>::value){
+        return *this * g;
+    }
+    if(!g.isLoaded() || !this->loaded){
+        throw std::invalid_argument("One of the graphs is not loaded.");
+    }
+    size_t len = this->getNumVertices();
+    if(len != g.getNumVertices()){
+        throw std::invalid_argument("The given graph has different size.");
+    }
+    BasicGraph result;
+    if(std::is_same<S<W, D>, OrAnd<W, D>>::value){
+        std::vector<uint64_t> bufA, bufB;
+        const uint64_t *a = this->bitData(bufA);
+        const uint64_t *b = g.bitData(bufB);
+        result.vertices = len;
+        result.words = (len + 63) / 64;
+        std::vector<uint64_t> &bits = result.bitTable.write();
+        bits.assign(len * result.words, 0);
+        Gemm::multiplyBits(a, b, bits.data(), len, result.words);
+        result.storage = BITSET;
+        result.setLoaded();
+        result.directed = !result.isSymetric();
+        return result;
+    }
+    Matrix bufA, bufB;
+    const W *a = this->denseData(bufA);
+    const W *b = g.denseData(bufB);
+    Matrix temp(len * len);
+    Gemm::multiply<W, D, S<W, D>>(a, b, temp.data(), len);
+    result.loadMatrix(len, std::move(temp));
+    return result;
+}
+
+/*
+ The powers are kept as accumulators, the (or, and) powers are squared as bit rows.
+*/
+template<typename W, typename D>
+template<template<typename, typename> class S>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::power(size_t k) const{
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    size_t len = this->getNumVertices();
+    BasicGraph result;
+    if(std::is_same<S<W, D>, OrAnd<W, D>>::value){
+        size_t rowWords = (len + 63) / 64;
+        std::vector<uint64_t> buf;
+        const uint64_t *bits = this->bitData(buf);
+        std::vector<uint64_t> base(bits, bits + len * rowWords);
+        std::vector<uint64_t> identity(len * rowWords, 0);
+        for(size_t i = 0; i < len; i++){
+            identity[i * rowWords + (i >> 6)] |= 1ULL << (i & 63);
+        }
+        std::vector<uint64_t> reach = powerBySquaring(base, std::move(identity), k,
+            [&](const uint64_t *x, const uint64_t *y, uint64_t *out){Gemm::multiplyBits(x, y, out, len, rowWords);});
+        result.vertices = len;
+        result.words = rowWords;
+        result.bitTable.assign(std::move(reach));
+        result.storage = BITSET;
+        result.setLoaded();
+        result.directed = !result.isSymetric();
+        return result;
+    }
+    typedef S<W, D> Ring;
+    Matrix buf;
+    const W *a = this->denseData(buf);
+    std::vector<D> base(len * len);
+    for(size_t c = 0; c < len * len; c++){
+        base[c] = Ring::load(a[c]);
+    }
+    std::vector<D> identity(len * len, Ring::zero());
+    for(size_t i = 0; i < len; i++){
+        identity[i * len + i] = Ring::one();
+    }
+    bool plusTimes = std::is_same<Ring, PlusTimes<W, D>>::value;
+    std::vector<D> powered = powerBySquaring(base, std::move(identity), k,
+        [&](const D *x, const D *y, D *out){accumulatedProduct<Ring>(x, y, out, len, plusTimes);});
+    Matrix temp(len * len);
+    for(size_t c = 0; c < len * len; c++){
+        temp[c] = Ring::store(powered[c]);
+    }
+    result.loadMatrix(len, std::move(temp));
+    return result;
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<W, D> GraphLib::BasicGraph<W, D>::power(size_t k, D modulus) const{
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    if(!std::is_integral<W>::value){
+        throw std::invalid_argument("The modulus is only defined for integral weights.");
+    }
+    size_t len = this->getNumVertices();
+    // the residues are stored as W, so the largest one has to fit it
+    if(!(modulus > 0) || modulus > D(1LL << 32) || modulus - 1 > static_cast<D>(std::numeric_limits<W>::max()) || len > (1 << 15)){
+        throw std::invalid_argument("The modulus is not supported for this graph.");
+    }
+    Matrix buf;
+    const W *a = this->denseData(buf);
+    std::vector<D> base(len * len);
+    for(size_t c = 0; c < len * len; c++){
+        base[c] = reduce(static_cast<D>(a[c]), modulus, std::is_integral<W>());
+    }
+    std::vector<D> identity(len * len, D(0));
+    for(size_t i = 0; i < len; i++){
+        identity[i * len + i] = reduce(D(1), modulus, std::is_integral<W>());
+    }
+    std::vector<D> powered = powerBySquaring(base, std::move(identity), k,
+        [&](const D *x, const D *y, D *out){modularProduct(x, y, out, len, modulus, std::is_integral<W>());});
+    Matrix temp(powered.begin(), powered.end());
+    BasicGraph result;
+    result.loadMatrix(len, std::move(temp));
+    return result;
+}
+
+template<typename W, typename D>
+GraphLib::BasicGraph<D> GraphLib::BasicGraph<W, D>::widePower(size_t k) const{
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
+    }
+    size_t len = this->getNumVertices();
+    Matrix buf;
+    const W *a = this->denseData(buf);
+    std::vector<D> base(a, a + len * len);
+    std::vector<D> identity(len * len, D(0));
+    for(size_t i = 0; i < len; i++){
+        identity[i * len + i] = D(1);
+    }
+    std::vector<D> powered = powerBySquaring(base, std::move(identity), k,
+        [&](const D *x, const D *y, D *out){accumulatedProduct<PlusTimes<W, D>>(x, y, out, len, true);});
+    typename BasicGraph<D>::Matrix wide(powered.begin(), powered.end());
+    BasicGraph<D> result;
+    result.loadGraph(len, std::move(wide));
+    return result;
+}
+
+/*
+ The sizes and the cached fingerprints are compared first, most different graphs are rejected without reading a cell.
+ Graphs with equal fingerprints are almost always equal, their matrices are compared to be sure.
+*/
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::operator==(const GraphLib::BasicGraph<W, D> &g) const{
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
@@ -442,9 +1626,20 @@ bool GraphLib::Graph::operator==(const GraphLib::Graph &g) const{
     if(vxs1 != vxs2){
         return false;
     }
+    const OrderKey &key1 = this->orderKey();
+    const OrderKey &key2 = g.orderKey();
+    if(key1.edges != key2.edges || key1.hash != key2.hash){
+        return false;
+    }
+    if((this->storage == DENSE && g.storage == DENSE) || (this->storage == PACKED && g.storage == PACKED)){
+        return *this->adjTable == *g.adjTable;
+    }
+    if(this->storage == BITSET && g.storage == BITSET){
+        return *this->bitTable == *g.bitTable;
+    }
     for(size_t i = 0; i<vxs1; i++){
         for(size_t j = 0; j<vxs1; j++){
-            if(this->adjTable[i][j] != g.getWeight(i, j)){
+            if(this->at(i, j) != g.at(i, j)){
                 return false;
             }
         }
@@ -452,7 +1647,8 @@ bool GraphLib::Graph::operator==(const GraphLib::Graph &g) const{
     return true;
 }
 
-bool GraphLib::Graph::operator!=(const GraphLib::Graph &g) const{
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::operator!=(const GraphLib::BasicGraph<W, D> &g) const{
     try{
         return !(*this == g);
     }
@@ -461,48 +1657,89 @@ bool GraphLib::Graph::operator!=(const GraphLib::Graph &g) const{
     }
 }
 
-bool GraphLib::Graph::operator<(const GraphLib::Graph &g) const
-{
-    if(!g.isLoaded() || !this->loaded){
-        throw std::invalid_argument("One of the graphs is not loaded.");
+/*
+ This method returns the ordering key of the graph, computed in one pass over the edges the first time it is needed,
+ under the cache lock so concurrent const calls compute it once.
+*/
+template<typename W, typename D>
+const typename GraphLib::BasicGraph<W, D>::OrderKey& GraphLib::BasicGraph<W, D>::orderKey() const{
+    if(this->keyValid.load(std::memory_order_acquire)){
+        return this->key;
+    }
+    std::lock_guard<std::mutex> lock(this->cacheLock);
+    if(!this->keyValid.load(std::memory_order_relaxed)){
+        OrderKey computed = {0, 0};
+        for(size_t u = 0; u < this->vertices; u++){
+            for(const Edge &e : this->neighbours(u)){
+                computed.edges++;
+                computed.hash += edgeHash(u, e.to, e.weight);
+            }
+        }
+        this->key = computed;
+        this->keyValid.store(true, std::memory_order_release);
     }
+    return this->key;
+}
 
-    // G1 is a subgraph of G2 then, G1 < G2
-    if(this->subGraph(g)){
-        return true;
+template<typename W, typename D>
+uint64_t GraphLib::BasicGraph<W, D>::hash() const{
+    if(!this->loaded){
+        throw std::invalid_argument("The graph is not loaded.");
     }
-    // G1 > G2 or G1 == G2
-    if(g.subGraph(*this) || *this == g){
-        return false;
+    // the number of vertices is mixed in, so graphs without edges of different sizes differ
+    return mix(this->orderKey().hash ^ mix((uint64_t)this->vertices));
+}
+
+/*
+ This method compares the matrices of two graphs of the same size cell by cell in row-major order,
+ the first cell that differs decides.
+*/
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::contentLess(const GraphLib::BasicGraph<W, D> &g) const{
+    Matrix bufA, bufB;
+    const W *a = this->denseData(bufA);
+    const W *b = g.denseData(bufB);
+    size_t cells = this->vertices * this->vertices;
+    return std::lexicographical_compare(a, a + cells, b, b + cells);
+}
+
+/*
+ The graphs are compared by their cached keys: the number of edges, the number of vertices and the content hash.
+ A strict subgraph has at most as many edges and less vertices, so it always comes first.
+ The matrices are only read when the keys tie, which means the graphs are equal or their hashes collide.
+*/
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::operator<(const GraphLib::BasicGraph<W, D> &g) const
+{
+    if(!g.isLoaded() || !this->loaded){
+        throw std::invalid_argument("One of the graphs is not loaded.");
     }
-    int edge1 = this->countEdges();
-    int edge2 = g.countEdges();
-    // G1 has less edges than G2 then, G1 < G2
-    if(edge1 < edge2){
-        return true;
+    const OrderKey &key1 = this->orderKey();
+    const OrderKey &key2 = g.orderKey();
+    if(key1.edges != key2.edges){
+        return key1.edges < key2.edges;
     }
-    // G1 > G2
-    if(edge1 > edge2){
-        return false;
+    if(this->vertices != g.vertices){
+        return this->vertices < g.vertices;
     }
-    //G1 has less vertices than G2 then, G1 < G2
-    if(this->getNumVertices() < g.getNumVertices()){
-        return true;
+    if(key1.hash != key2.hash){
+        return key1.hash < key2.hash;
     }
-    return false;
-
+    return this->contentLess(g);
 }
 
-bool GraphLib::Graph::operator<=(const GraphLib::Graph &g) const
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::operator<=(const GraphLib::BasicGraph<W, D> &g) const
 {
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
     }
-    return *this == g || *this < g;
+    return !(g < *this);
 }
 
 
-bool GraphLib::Graph::operator>(const GraphLib::Graph &g) const
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::operator>(const GraphLib::BasicGraph<W, D> &g) const
 {
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
@@ -510,7 +1747,8 @@ bool GraphLib::Graph::operator>(const GraphLib::Graph &g) const
     return g < *this;
 }
 
-bool GraphLib::Graph::operator>=(const GraphLib::Graph &g) const
+template<typename W, typename D>
+bool GraphLib::BasicGraph<W, D>::operator>=(const GraphLib::BasicGraph<W, D> &g) const
 {
     if(!g.isLoaded() || !this->loaded){
         throw std::invalid_argument("One of the graphs is not loaded.");
@@ -518,7 +1756,8 @@ bool GraphLib::Graph::operator>=(const GraphLib::Graph &g) const
     return !(*this < g);
 }
 
-std::ostream& GraphLib::operator<<(std::ostream& os, const GraphLib::Graph& g)
+template<typename W, typename D>
+std::ostream& GraphLib::operator<<(std::ostream& os, const GraphLib::BasicGraph<W, D>& g)
 {
     if(!g.isLoaded()){
         throw std::invalid_argument("The graph is not loaded.");
@@ -527,10 +1766,24 @@ std::ostream& GraphLib::operator<<(std::ostream& os, const GraphLib::Graph& g)
     for(size_t i = 0; i<len; i++){
         os << "[ ";
         for(size_t j = 0; j<len; j++){
-            os << g.getWeight(i, j) << " ";
+            // unary + prints 8 bit weights as numbers
+            os << +g.weightAt(i, j) << " ";
         }
         os << "]" << std::endl;
     }
     os << std::endl;
     return os;
-}
\ No newline at end of file
+}
+
+#define GRAPHLIB_INSTANTIATE_GRAPH(W) \
+    template class GraphLib::BasicGraph<W>; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::multiply<GraphLib::PlusTimes>(const GraphLib::BasicGraph<W> &g) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::multiply<GraphLib::MinPlus>(const GraphLib::BasicGraph<W> &g) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::multiply<GraphLib::OrAnd>(const GraphLib::BasicGraph<W> &g) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::multiply<GraphLib::MaxMin>(const GraphLib::BasicGraph<W> &g) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::power<GraphLib::PlusTimes>(size_t k) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::power<GraphLib::MinPlus>(size_t k) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::power<GraphLib::OrAnd>(size_t k) const; \
+    template GraphLib::BasicGraph<W> GraphLib::BasicGraph<W>::power<GraphLib::MaxMin>(size_t k) const; \
+    template std::ostream& GraphLib::operator<<(std::ostream& os, const GraphLib::BasicGraph<W>& g);
+GRAPHLIB_FOR_EACH_WEIGHT(GRAPHLIB_INSTANTIATE_GRAPH)
@@ -1,50 +1,396 @@
 #include <vector>
 #include <iostream>
 #include <stdexcept>
+#include <cstdlib>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <new>
+#include <utility>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "Kernels.hpp"
 #pragma once
 
 namespace GraphLib{
-    #define INT_MAX 2147483647
     #define NO_EDGE 0
     enum Color{WHITE, GRAY, BLACK};
 
     /**
-     * @class Graph
+     * @brief The weight types the library is compiled for, each one with its default accumulator.
+     * @brief X is a macro that is expanded once per weight type.
+    **/
+    #define GRAPHLIB_FOR_EACH_WEIGHT(X) X(int8_t) X(uint8_t) X(int16_t) X(int32_t) X(int64_t) X(float) X(double)
+
+    /**
+     * @brief The type used to accumulate products and path distances of weights of type W,
+     * @brief 64 bit integers for integral weights and double for floating point weights.
+    **/
+    template<typename W>
+    struct DefaultAccumulator {
+        typedef typename std::conditional<std::is_floating_point<W>::value, double, int64_t>::type type;
+    };
+
+    /**
+     * @return The sentinel value of type D that represents an unreachable vertex.
+    **/
+    template<typename D>
+    inline D infinity() {return std::numeric_limits<D>::max();}
+
+    /**
+     * @brief The way the adjacency matrix of a graph is stored.
+     * @brief DENSE - a row-major matrix, SPARSE - compressed sparse rows,
+     * @brief BITSET - one bit per cell, chosen automatically for unweighted graphs,
+     * @brief PACKED - the upper triangle of a symmetric matrix, chosen automatically for undirected weighted graphs.
+    **/
+    enum Storage{DENSE, SPARSE, BITSET, PACKED};
+
+    /**
+     * @class AlignedAllocator
+     * @brief Allocator that places buffers on a cache line boundary, so every matrix starts aligned
+     * @brief for vector loads.
+    **/
+    template<typename T>
+    class AlignedAllocator {
+        public:
+        typedef T value_type;
+        static const size_t ALIGNMENT = 64;
+        template<typename U> struct rebind {typedef AlignedAllocator<U> other;};
+        AlignedAllocator() {}
+        template<typename U> AlignedAllocator(const AlignedAllocator<U> &) {}
+        T* allocate(size_t n) {
+            void *ptr = nullptr;
+            if(posix_memalign(&ptr, ALIGNMENT, n * sizeof(T) == 0 ? ALIGNMENT : n * sizeof(T)) != 0){
+                throw std::bad_alloc();
+            }
+            return static_cast<T*>(ptr);
+        }
+        void deallocate(T *ptr, size_t) {free(ptr);}
+        template<typename U> bool operator==(const AlignedAllocator<U> &) const {return true;}
+        template<typename U> bool operator!=(const AlignedAllocator<U> &) const {return false;}
+    };
+
+    /**
+     * @class Shared
+     * @brief A value shared by the copies of a graph until one of them changes it (copy on write).
+     * @brief Copying a Shared only copies a reference, reading never copies the value and write()
+     * @brief copies it first if another graph still refers to it. An empty Shared holds no value and reads as T().
+    **/
+    template<typename T>
+    class Shared {
+        private:
+        std::shared_ptr<T> ptr;
+        static const T& empty() {static const T value; return value;}
+        public:
+        Shared() {}
+        const T& operator*() const {return ptr ? *ptr : empty();}
+        const T* operator->() const {return &**this;}
+        /**
+         * @return The value, owned by this Shared only.
+        **/
+        T& write() {
+            if(!ptr){
+                ptr = std::make_shared<T>();
+            }
+            else if(ptr.use_count() != 1){
+                ptr = std::make_shared<T>(*ptr);
+            }
+            return *ptr;
+        }
+        /**
+         * @brief Replaces the value without copying the old one, the given value is moved in.
+        **/
+        void assign(T &&value) {ptr = std::make_shared<T>(std::move(value));}
+        void reset() {ptr.reset();}
+        /**
+         * @return Whether another graph refers to the same value.
+        **/
+        bool shared() const {return ptr && ptr.use_count() != 1;}
+    };
+
+    /**
+     * @struct BasicCSR
+     * @brief Compressed sparse row representation of an adjacency matrix.
+     * @brief The neighbours of vertex u are cols[offsets[u]] ... cols[offsets[u+1]-1] with the matching weights,
+     * @brief every row is sorted by column and holds no NO_EDGE entries.
+    **/
+    template<typename W>
+    struct BasicCSR {
+        std::vector<size_t> offsets;
+        std::vector<size_t> cols;
+        std::vector<W> weights;
+    };
+    typedef BasicCSR<int> CSR;
+
+    /**
+     * @struct BasicEdge
+     * @brief An outgoing edge, as returned while iterating the neighbours of a vertex.
+    **/
+    template<typename W>
+    struct BasicEdge {
+        size_t to;
+        W weight;
+    };
+
+    /**
+     * @struct BasicEdgeUpdate
+     * @brief A change of a single cell of the adjacency matrix, a NO_EDGE weight removes the edge.
+    **/
+    template<typename W>
+    struct BasicEdgeUpdate {
+        size_t from;
+        size_t to;
+        W weight;
+    };
+
+    /**
+     * @class RowSpan
+     * @brief A read only view of one row of a dense adjacency matrix, a pointer and a length.
+     * @brief The view does not copy the row and stays valid until the graph changes.
+    **/
+    template<typename W>
+    class RowSpan {
+        private:
+        const W *first;
+        size_t len;
+        public:
+        RowSpan(const W *first, size_t len) : first(first), len(len) {}
+        const W* data() const {return first;}
+        size_t size() const {return len;}
+        bool empty() const {return len == 0;}
+        W operator[](size_t j) const {return first[j];}
+        const W* begin() const {return first;}
+        const W* end() const {return first + len;}
+    };
+
+    /**
+     * @return The position of the cell (i, j), i <= j, in the upper triangle of an n x n matrix stored row by row.
+    **/
+    inline size_t packedIndex(size_t i, size_t j, size_t n) {return i * (2 * n - i - 1) / 2 + j;}
+
+    /**
+     * @class NeighbourIterator
+     * @brief Iterates the existing edges of one row, either a dense matrix row (skipping NO_EDGE),
+     * @brief a CSR row, a bit row (scanning a word at a time with count-trailing-zeros) or a row of a packed
+     * @brief upper triangle, read down column u before the diagonal and along row u from it.
+    **/
+    template<typename W>
+    class NeighbourIterator {
+        private:
+        const W *row; // dense row, nullptr when iterating a CSR or bit row
+        const size_t *cols;
+        const W *weights;
+        const uint64_t *bits; // bit row, nullptr when iterating a dense or CSR row
+        const W *packed; // packed upper triangle, nullptr unless iterating a packed row
+        size_t vertex; // the row of the packed triangle
+        size_t pos;
+        size_t end;
+        W packedAt(size_t j) const {
+            return j < vertex ? packed[packedIndex(j, vertex, end)] : packed[packedIndex(vertex, j, end)];
+        }
+        void skipEmpty() {
+            if(row != nullptr){
+                while(pos < end && row[pos] == NO_EDGE){pos++;}
+            }
+            else if(packed != nullptr){
+                while(pos < end && packedAt(pos) == NO_EDGE){pos++;}
+            }
+            else if(bits != nullptr && pos < end){
+                size_t w = pos >> 6;
+                uint64_t word = bits[w] & (~0ULL << (pos & 63));
+                size_t words = (end + 63) >> 6;
+                while(word == 0 && ++w < words){
+                    word = bits[w];
+                }
+                pos = word == 0 ? end : (w << 6) + (size_t)__builtin_ctzll(word);
+            }
+        }
+        public:
+        NeighbourIterator(const W *row, const size_t *cols, const W *weights, const uint64_t *bits, size_t pos, size_t end)
+            : row(row), cols(cols), weights(weights), bits(bits), packed(nullptr), vertex(0), pos(pos), end(end) {skipEmpty();}
+        NeighbourIterator(const W *packed, size_t vertex, size_t pos, size_t end)
+            : row(nullptr), cols(nullptr), weights(nullptr), bits(nullptr), packed(packed), vertex(vertex), pos(pos), end(end) {skipEmpty();}
+        BasicEdge<W> operator*() const {
+            if(row != nullptr){
+                return BasicEdge<W>{pos, row[pos]};
+            }
+            if(bits != nullptr){
+                return BasicEdge<W>{pos, static_cast<W>(1)};
+            }
+            if(packed != nullptr){
+                return BasicEdge<W>{pos, packedAt(pos)};
+            }
+            return BasicEdge<W>{cols[pos], weights[pos]};
+        }
+        NeighbourIterator& operator++() {pos++; skipEmpty(); return *this;}
+        bool operator!=(const NeighbourIterator &other) const {return pos != other.pos;}
+    };
+
+    /**
+     * @class NeighbourRange
+     * @brief The range of the edges leaving a single vertex, usable in a range based for loop.
+    **/
+    template<typename W>
+    class NeighbourRange {
+        private:
+        NeighbourIterator<W> first;
+        NeighbourIterator<W> last;
+        public:
+        NeighbourRange(NeighbourIterator<W> first, NeighbourIterator<W> last) : first(first), last(last) {}
+        NeighbourIterator<W> begin() const {return first;}
+        NeighbourIterator<W> end() const {return last;}
+    };
+
+    template<typename W, typename D>
+    class BasicGraph;
+
+    template<typename E, typename W>
+    class GraphExpr;
+
+    template<typename W, typename D>
+    class GraphLeaf;
+
+    template<typename W, typename D>
+    struct PlusTimes;
+
+    template<typename W, typename D>
+    std::ostream& operator<<(std::ostream& os, const BasicGraph<W, D> &g);
+
+    /**
+     * @class BasicGraph
      * @brief This class represents a graph.
      * @brief The graph can be directed or undirected, weighted or unweighted.
      * @brief The graph can contain negative values or not.
      * @brief The graph uses an adjacency matrix to represent the graph, hence 
      * @brief the graph is loaded by squared matrices only. 
      * @brief The graph can not have an edge weighted as 0, the value 0 is used to represent no edge.
+     * @tparam W The type of the edge weights.
+     * @tparam D The type used to accumulate weights, in matrix products and in path distances.
      **/
-    class Graph {
+    template<typename W, typename D = typename DefaultAccumulator<W>::type>
+    class BasicGraph {
+        public:
+        typedef W weight_type;
+        typedef D distance_type;
+        typedef BasicCSR<W> CSR;
+        typedef BasicEdge<W> Edge;
+        typedef BasicEdgeUpdate<W> EdgeUpdate;
+        /**
+         * @brief A square matrix stored row-major in one contiguous buffer, entry (i, j) lives at i * n + j.
+        **/
+        typedef std::vector<W, AlignedAllocator<W>> Matrix;
+
         private:
-        std::vector<std::vector<int>> adjTable;
+        // the storage is shared between copies until one of them changes,
+        // adjTable holds the whole matrix in dense mode and its upper triangle in packed mode
+        Shared<Matrix> adjTable;
+        Shared<CSR> csr;
+        Shared<std::vector<uint64_t>> bitTable;
+        size_t vertices;
+        size_t words; // 64 bit words per row of bitTable
+        Storage storage;
         bool directed;
         bool weighted;
         bool negValues;
         bool loaded;
+        // the ordering key and fingerprint, edge count and a hash of the content, computed by the first
+        // comparison or hash and kept until the matrix changes
+        struct OrderKey {
+            size_t edges;
+            uint64_t hash;
+        };
+        mutable OrderKey key;
+        mutable std::atomic<bool> keyValid;
+        const OrderKey& orderKey() const;
+        // the counts the flags are derived from, computed in one pass the first time they are needed
+        // and kept until the matrix changes, a single changed cell updates them in O(1)
+        struct Counters {
+            size_t edges;
+            size_t negative; // entries < 0
+            size_t heavy; // entries > 1
+            size_t asymmetric; // pairs i < j with a different weight in each direction
+            W heaviest; // the largest entry, a write only raises it, so it is an upper bound until the next count
+        };
+        mutable Counters counters;
+        mutable std::atomic<bool> countersValid;
+        // the largest weight found by maxWeightBound() while the counters are not cached, dropped with them
+        mutable W heaviest;
+        mutable std::atomic<bool> heaviestValid;
+        // const methods may fill the key, the counters and the largest weight from several threads at once: the first one computes
+        // them under the lock and sets the flag with release, later calls see the flag with acquire and skip the lock
+        mutable std::mutex cacheLock;
+        const Counters& getCounters() const;
+        void setCounterFlags();
+        void changeCell(size_t u, size_t v, W value);
+        void checkVertices(size_t u, size_t v) const;
+        void mergeSparse(const std::vector<EdgeUpdate> &sorted);
+        bool contentLess(const BasicGraph &g) const;
         bool isSymetric();
-        void copyFlags(const GraphLib::Graph &g);
+        void copyFlags(const BasicGraph &g);
         void setDirected() { directed = true; }
         void setWeighted() {weighted = true;}
         void setNegValues() {negValues = true;}
         void setLoaded() {loaded = true;}
-        void clear() {adjTable.clear();loaded = false; directed = false; weighted = false; negValues = false;}
+        void clear() {adjTable.reset(); csr.reset(); bitTable.reset(); vertices = 0; words = 0; storage = DENSE; loaded = false; directed = false; weighted = false; negValues = false; keyValid = false; countersValid = false; heaviestValid = false;}
+        W sparseWeight(size_t i, size_t j) const;
+        W at(size_t i, size_t j) const {
+            switch(storage){
+                case SPARSE: return sparseWeight(i, j);
+                case BITSET: return static_cast<W>(((*bitTable)[i * words + (j >> 6)] >> (j & 63)) & 1);
+                case PACKED: return (*adjTable)[i <= j ? packedIndex(i, j, vertices) : packedIndex(j, i, vertices)];
+                default: return (*adjTable)[i * vertices + j];
+            }
+        }
+        const W* row(size_t i) const {return adjTable->data() + i * vertices;}
+        const W* denseData(Matrix &buffer) const;
+        const uint64_t* bitData(std::vector<uint64_t> &buffer) const;
+        void loadMatrix(size_t len, Matrix &&mat);
+        void loadMatrix(size_t len, Matrix &&mat, const Kernels::Flags &flags, bool symmetric);
+        void loadPacked(size_t len, Matrix &&mat, const Kernels::Flags &flags);
+        void setKernelFlags(const Kernels::Flags &flags, bool symmetric);
+        void toBitset();
+        void toPacked();
+        void compact();
+        template<typename W2, typename D2> friend class GraphLeaf;
         public:
-        Graph();
+        BasicGraph();
 
-        ~Graph();
+        ~BasicGraph();
 
         /**
-         * @brief This is a copy constructor.
+         * @brief This is a copy constructor, the storage is shared with the given graph so the copy takes O(1)
+         * @brief and is only copied when one of the graphs changes.
          * @throws std::invalid_argument if the given graph is not loaded.
         **/
-        Graph(const Graph &g) {
+        BasicGraph(const BasicGraph &g) {
             if(!g.loaded){throw std::invalid_argument("The given graph is not loaded.");}
             adjTable = g.adjTable;
+            csr = g.csr;
+            bitTable = g.bitTable;
+            vertices = g.vertices;
+            words = g.words;
+            storage = g.storage;
             copyFlags(g);
         }
+
+        /**
+         * @brief This is a move constructor, the storage of the given graph is taken over without copying.
+         * @brief The given graph is left unloaded.
+        **/
+        BasicGraph(BasicGraph &&g) noexcept
+            : adjTable(std::move(g.adjTable)), csr(std::move(g.csr)), bitTable(std::move(g.bitTable)),
+              vertices(g.vertices), words(g.words), storage(g.storage) {
+            copyFlags(g);
+            g.clear();
+        }
+
+        /**
+         * @brief Computes a lazy expression (see lazy() in GraphExpr.hpp) in a single pass into a new graph.
+         * @throws std::invalid_argument if the expression is invalid.
+        **/
+        template<typename E>
+        BasicGraph(const GraphExpr<E, W> &expr);
         
         /**
          * @return The number of vertices in the graph.
@@ -52,7 +398,7 @@ namespace GraphLib{
         **/
         size_t getNumVertices() const {
             if(!loaded){throw std::invalid_argument("The graph is not loaded.");}
-            return adjTable.size();
+            return vertices;
         }
 
         /**
@@ -61,19 +407,206 @@ namespace GraphLib{
          * @return The weight of the edge between the two vertices.
          * @throws std::invalid_argument if the given vertices are out of range or the graph is not loaded.
         **/
-        int getWeight(size_t i, size_t j) const {
-            if(i >= adjTable.size() || j >= adjTable.size()){throw std::invalid_argument("The given vertices are out of range.");}
+        W getWeight(size_t i, size_t j) const {
             if(!loaded){throw std::invalid_argument("The graph is not loaded.");}
-            return adjTable[i][j];
+            if(i >= vertices || j >= vertices){throw std::invalid_argument("The given vertices are out of range.");}
+            return at(i, j);
+        }
+
+        /**
+         * @brief The same as getWeight without any check, for the inner loops of algorithms
+         * @brief that already checked the graph is loaded and the vertices are in range.
+         * @param i The vertex that the edge "lefts", less than the number of vertices.
+         * @param j The vertex that the edge "enters", less than the number of vertices.
+         * @return The weight of the edge between the two vertices.
+        **/
+        W weightAt(size_t i, size_t j) const {return at(i, j);}
+
+        /**
+         * @param u The vertex whose row is returned.
+         * @return A view of row u of the matrix without copying it, empty unless the graph is in dense mode.
+         * @throws std::invalid_argument if the vertex is out of range or the graph is not loaded.
+        **/
+        RowSpan<W> getRow(size_t u) const {
+            if(u >= getNumVertices()){throw std::invalid_argument("The given vertices are out of range.");}
+            return storage == DENSE ? RowSpan<W>(row(u), vertices) : RowSpan<W>(nullptr, 0);
         }
 
+        /**
+         * @param u The vertex whose outgoing edges are iterated.
+         * @return A range over the existing edges leaving u, ordered by destination vertex.
+         * @brief In sparse mode only the real neighbours are visited, in bitset mode the row is scanned a word at a time
+         * @brief and in dense and packed mode the row is scanned.
+         * @throws std::invalid_argument if the vertex is out of range or the graph is not loaded.
+        **/
+        NeighbourRange<W> neighbours(size_t u) const {
+            if(u >= getNumVertices()){throw std::invalid_argument("The given vertices are out of range.");}
+            if(storage == SPARSE){
+                NeighbourIterator<W> first(nullptr, csr->cols.data(), csr->weights.data(), nullptr, csr->offsets[u], csr->offsets[u + 1]);
+                NeighbourIterator<W> last(nullptr, csr->cols.data(), csr->weights.data(), nullptr, csr->offsets[u + 1], csr->offsets[u + 1]);
+                return NeighbourRange<W>(first, last);
+            }
+            if(storage == BITSET){
+                NeighbourIterator<W> first(nullptr, nullptr, nullptr, getBitRow(u), 0, vertices);
+                NeighbourIterator<W> last(nullptr, nullptr, nullptr, getBitRow(u), vertices, vertices);
+                return NeighbourRange<W>(first, last);
+            }
+            if(storage == PACKED){
+                NeighbourIterator<W> first(adjTable->data(), u, 0, vertices);
+                NeighbourIterator<W> last(adjTable->data(), u, vertices, vertices);
+                return NeighbourRange<W>(first, last);
+            }
+            NeighbourIterator<W> first(row(u), nullptr, nullptr, nullptr, 0, vertices);
+            NeighbourIterator<W> last(row(u), nullptr, nullptr, nullptr, vertices, vertices);
+            return NeighbourRange<W>(first, last);
+        }
+
+        /**
+         * @param u The vertex whose row is returned.
+         * @return The adjacency bits of u, bit j of word j/64 is set if the edge (u, j) exists,
+         * @return the bits past the last vertex are always 0. nullptr unless the graph is in bitset mode.
+        **/
+        const uint64_t* getBitRow(size_t u) const {
+            return storage == BITSET ? bitTable->data() + u * words : nullptr;
+        }
+
+        /**
+         * @return The number of 64 bit words in every bit row.
+        **/
+        size_t getBitRowWords() const {return words;}
+
         /**
          * @brief This method loads values to the adjacency matrix that represents the graph.
+         * @brief The rows are copied into a single contiguous buffer, this is only an import path.
          * @param mat The matrix that represents the graph.
          * @return true if the graph is loaded, false otherwise.
          * @throws std::invalid_argument if the given matrix is not squared or empty.
         **/
-        void loadGraph(std::vector<std::vector<int>> mat);
+        void loadGraph(const std::vector<std::vector<W>> &mat);
+
+        /**
+         * @brief This method loads values to the adjacency matrix that represents the graph.
+         * @brief Every row is released right after it is copied, so the peak memory stays about one matrix.
+         * @param mat The matrix that represents the graph, it is left empty.
+         * @throws std::invalid_argument if the given matrix is not squared or empty.
+        **/
+        void loadGraph(std::vector<std::vector<W>> &&mat);
+
+        /**
+         * @brief This method loads a row-major matrix, the buffer is taken over without copying.
+         * @param len The number of vertices.
+         * @param mat The len*len matrix, entry (i, j) at i * len + j, it is left empty.
+         * @throws std::invalid_argument if the given matrix is empty or its size is not len*len.
+        **/
+        void loadGraph(size_t len, Matrix &&mat);
+
+        /**
+         * @brief This method loads a graph given in compressed sparse row form, the graph is kept in sparse mode.
+         * @param mat The CSR representation, offsets must hold (number of vertices + 1) entries.
+         * @throws std::invalid_argument if the given representation is empty or malformed,
+         * @throws a row that is not sorted, has a duplicate column, a column out of range or a 0 weight is malformed.
+        **/
+        void loadGraph(const CSR &mat);
+
+        /**
+         * @brief This method converts the graph to compressed sparse row storage.
+         * @brief Algorithms then only visit the real neighbours of every vertex.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        void toSparse();
+
+        /**
+         * @brief This method converts the graph back to an adjacency matrix.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        void toDense();
+
+        /**
+         * @return Whether the graph is stored in compressed sparse row form.
+        **/
+        bool isSparse() const {return storage == SPARSE;}
+
+        /**
+         * @return Whether the graph is stored as bit rows, this happens automatically for unweighted graphs.
+        **/
+        bool isBitset() const {return storage == BITSET;}
+
+        /**
+         * @return Whether only the upper triangle of the matrix is stored, this happens automatically for
+         * @return undirected weighted graphs, a change that breaks the symmetry switches the graph to a dense matrix.
+        **/
+        bool isPacked() const {return storage == PACKED;}
+
+        /**
+         * @return The compressed sparse row representation of the graph.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        CSR getCSR() const;
+
+        /**
+         * @brief This method sets the weight of the edge (u, v), adding it if it does not exist.
+         * @brief The flags, the edge count and the fingerprint are updated in O(1), the counters are read once
+         * @brief after every operator that rewrites the whole matrix. A dense or bitset graph changes one cell,
+         * @brief a bitset graph that gets a weight other than 1 switches to a dense matrix once, and so does a packed
+         * @brief graph that gets an edge off the diagonal, which breaks its symmetry. A sparse graph
+         * @brief finds the edge by binary search, adding or removing an edge shifts the edges of the later rows.
+         * @param u The vertex that the edge "lefts".
+         * @param v The vertex that the edge "enters".
+         * @param w The new weight, NO_EDGE removes the edge.
+         * @throws std::invalid_argument if the graph is not loaded or the given vertices are out of range.
+        **/
+        void setEdge(size_t u, size_t v, W w);
+
+        /**
+         * @brief This method removes the edge (u, v) if it exists, the same as setEdge(u, v, NO_EDGE).
+         * @throws std::invalid_argument if the graph is not loaded or the given vertices are out of range.
+        **/
+        void removeEdge(size_t u, size_t v);
+
+        /**
+         * @brief This method applies a burst of edge updates, the result is the same as applying them in the given order.
+         * @brief The updates are sorted by row and column, only the last one of every cell is kept, and the matrix is
+         * @brief swept once in row order. A sparse graph merges every CSR row with its updates into new arrays and
+         * @brief counts its flags once, in O(E + k log k) for k updates. The flags of a dense or bitset graph are
+         * @brief updated in O(1) per cell.
+         * @brief All the vertices are checked first, so either every update is applied or none.
+         * @param updates The first update, a NO_EDGE weight removes the edge.
+         * @param count The number of updates.
+         * @throws std::invalid_argument if the graph is not loaded or one of the vertices is out of range.
+        **/
+        void applyUpdates(const EdgeUpdate *updates, size_t count);
+
+        /**
+         * @brief This method sets the weights of many edges, in the given order, see applyUpdates.
+         * @param updates The edges to set, a NO_EDGE weight removes the edge.
+         * @throws std::invalid_argument if the graph is not loaded or one of the vertices is out of range.
+        **/
+        void setEdges(const std::vector<EdgeUpdate> &updates);
+
+        /**
+         * @brief This method removes many edges, the edges that do not exist are ignored.
+         * @brief All the vertices are checked first, so either every edge is removed or none.
+         * @param edges The (u, v) pairs of the edges to remove.
+         * @throws std::invalid_argument if the graph is not loaded or one of the vertices is out of range.
+        **/
+        void removeEdges(const std::vector<std::pair<size_t, size_t>> &edges);
+
+        /**
+         * @brief This method adds a vertex without edges, its index is the previous number of vertices.
+         * @brief A sparse graph appends one row offset and a bitset graph one bit row, unless the rows need
+         * @brief another word. A dense matrix or a packed triangle is copied into a larger one, so add many vertices
+         * @brief with addVertices.
+         * @return The index of the new vertex.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        size_t addVertex();
+
+        /**
+         * @brief This method adds count vertices without edges, the matrix is resized at most once.
+         * @return The index of the first new vertex.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        size_t addVertices(size_t count);
         /**
          * @brief This method prints information about the graph in the following format:
          * @brief "This is {a directed/ an undirected} graph with {number of vertices} vertices and {number of edges} edges."
@@ -86,6 +619,12 @@ namespace GraphLib{
         **/
         bool isDirected() const {return directed;}
 
+        /**
+         * @return Whether every pair of vertices has the same weight in both directions, counted with the flags.
+         * @return Unlike isDirected, it is not changed by setUnDirected.
+        **/
+        bool isSymmetricMatrix() const {return this->getCounters().asymmetric == 0;}
+
         void setUnDirected() {directed = false;}
 
         /**
@@ -98,38 +637,78 @@ namespace GraphLib{
         **/
         bool isNegValues() const {return negValues;}
 
+        /**
+         * @return An upper bound of the largest weight, counted with the flags and kept with them.
+         * @return A larger weight raises it at once, but lowering or removing the heaviest edge keeps it
+         * @return until the flags are counted again. NO_EDGE if the graph has no positive weight.
+         * @return When the flags are not counted, the largest stored weight is found in one pass over the edges
+         * @return and cached until the matrix changes, so it is safe to call from several threads.
+        **/
+        W maxWeightBound() const;
+
+        /**
+         * @brief This method reads maxWeightBound() only if it is already cached, it never counts it.
+         * @param bound Set to the bound if it is cached, left unchanged otherwise.
+         * @return Whether the bound was cached.
+        **/
+        bool cachedMaxWeightBound(W &bound) const {
+            if(this->countersValid.load(std::memory_order_acquire)){
+                bound = this->counters.heaviest;
+                return true;
+            }
+            if(this->heaviestValid.load(std::memory_order_acquire)){
+                bound = this->heaviest;
+                return true;
+            }
+            return false;
+        }
+
         /**
          * @return Whether the graph has been loaded or not.
         **/
         bool isLoaded() const {return loaded;}
 
         /**
-         * @return The adjacency matrix that represents the graph.
+         * @return A copy of the adjacency matrix that represents the graph,
+         * @return use getRow, neighbours or weightAt to read the graph without copying it.
         **/
-        std::vector<std::vector<int>> getGraph() const {return adjTable;}
+        std::vector<std::vector<W>> getGraph() const;
 
         /**
          * @brief This method updates all the boolean flags of a graph.
+         * @brief The edges, negative entries, entries greater than 1 and asymmetric pairs are counted
+         * @brief in a single pass over the matrix and the flags are derived from the counts.
          * @return void.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
         void updateGraphFlags();
 
         /**
-         * @brief This method checks if the current graph is a subgraph of given graph.
+         * @brief This method checks if the current graph is a subgraph of given graph,
+         * @brief that is if its matrix is a block of the matrix of the given graph (at any row and column offset).
+         * @brief The blocks are found by a 2D rolling hash in O(n^2) time and verified cell by cell.
          * @param g The graph to be checked if it contains the current graph.
          * @return true if the current graph is a subgraph of the given graph, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
         **/
-        bool subGraph(const Graph &g) const;
+        bool subGraph(const BasicGraph &g) const;
 
         /**
          * @brief This method counts how many edges a graph has.
+         * @brief The count is kept until the graph changes, so only the first call reads the matrix.
          * @return The number of edges in the graph.
          * @throws std::invalid_argument if the graph is not loaded. 
         **/
         int countEdges() const;
 
+        /**
+         * @brief This method returns a 64 bit fingerprint of the graph, equal graphs have equal fingerprints
+         * @brief whatever their storage. It is computed in one pass over the edges and cached until the graph changes.
+         * @return The fingerprint of the graph.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        uint64_t hash() const;
+
 // ---------------------------------------------------------------------------------------------
 //                    all of the overloaded operators
 // ---------------------------------------------------------------------------------------------    
@@ -140,7 +719,24 @@ namespace GraphLib{
          * @return The new graph after the copy.
          * @throws std::invalid_argument if the given graph is not loaded.
         **/
-        Graph& operator=(const Graph &g);
+        BasicGraph& operator=(const BasicGraph &g);
+
+        /**
+         * @brief This method overloads the operator = to move a graph, the storage is taken over without copying.
+         * @param g The graph to be moved, it is left unloaded.
+         * @return The current graph after the move.
+         * @throws std::invalid_argument if the given graph is not loaded.
+        **/
+        BasicGraph& operator=(BasicGraph &&g);
+
+        /**
+         * @brief This method overloads the operator = to compute a lazy expression into the graph.
+         * @brief The expression is computed in a single pass over the matrix and the flags are computed once.
+         * @param expr The expression, for example lazy(g1) + g2 * 3 - g3.
+         * @return The current graph after the assignment.
+        **/
+        template<typename E>
+        BasicGraph& operator=(const GraphExpr<E, W> &expr);
 
         /**
          * @brief This method overloads the operator + to add two graphs.
@@ -149,7 +745,12 @@ namespace GraphLib{
          * @throws std::invalid_argument if one of the graphs is not loaded.
          * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        Graph operator+(const Graph &g) const;
+        BasicGraph operator+(const BasicGraph &g) const &;
+
+        /**
+         * @brief The operator + on a temporary graph, the sum is written into its buffer instead of a new one.
+        **/
+        BasicGraph operator+(const BasicGraph &g) &&;
 
         /**
          * @brief This method overloads the operator += to add a graph to the current graph.
@@ -158,7 +759,7 @@ namespace GraphLib{
          * @throws std::invalid_argument if one of the graphs is not loaded.
          * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        Graph& operator+=(const Graph &g);
+        BasicGraph& operator+=(const BasicGraph &g);
 
         /**
          * @brief This method overloads the operator ++ to add 1 to all the values in the graph.
@@ -166,7 +767,7 @@ namespace GraphLib{
          * @return The current graph after the addition.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph& operator++();
+        BasicGraph& operator++();
         
         /**
          * @brief This method overloads the operator ++ to add 1 to all the values in the graph.
@@ -174,14 +775,14 @@ namespace GraphLib{
          * @return The current graph before the addition.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph operator++(int);
+        BasicGraph operator++(int);
 
         /**
          * @brief This method overloads the operator + to return the unary addition of a graph.
          * @return The current graph.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph operator+() const;
+        BasicGraph operator+() const;
 
         /**
          * @brief This method overloads the operator - to subtract two graphs.
@@ -190,7 +791,12 @@ namespace GraphLib{
          * @throws std::invalid_argument if one of the graphs is not loaded.
          * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        Graph operator-(const Graph &g) const;
+        BasicGraph operator-(const BasicGraph &g) const &;
+
+        /**
+         * @brief The operator - on a temporary graph, the difference is written into its buffer instead of a new one.
+        **/
+        BasicGraph operator-(const BasicGraph &g) &&;
 
         /**
          * @brief This method overloads the operator -= to subtract a graph from the current graph.
@@ -199,7 +805,7 @@ namespace GraphLib{
          * @throws std::invalid_argument if one of the graphs is not loaded.
          * @throws std::invalid_argument if the given graph is not the same size as the current graph. 
         **/
-        Graph& operator-=(const Graph &g);
+        BasicGraph& operator-=(const BasicGraph &g);
 
         /**
          * @brief This method overloads the operator -- to subtract 1 from all the values in the graph.
@@ -207,7 +813,7 @@ namespace GraphLib{
          *  @return The current graph after the subtraction.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph& operator--();
+        BasicGraph& operator--();
 
         /**
          * @brief This method overloads the operator -- to subtract 1 from all the values in the graph.
@@ -215,14 +821,19 @@ namespace GraphLib{
          * @return The current graph before the subtraction.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph operator--(int);
+        BasicGraph operator--(int);
 
         /**
          * @brief This method overloads the operator - to negate all the values in the graph.
          * @return pointer to the new graph that is the negation of the current graph.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph operator-() const;
+        BasicGraph operator-() const &;
+
+        /**
+         * @brief The unary operator - on a temporary graph, it is negated in place.
+        **/
+        BasicGraph operator-() &&;
     
         /**
          * @brief This method overloads the operator * to multiply the graph by a number. 
@@ -230,7 +841,12 @@ namespace GraphLib{
          * @return pointer to the new graph that is the multiplication of the current graph by the given number.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph operator*(int num) const;
+        BasicGraph operator*(W num) const &;
+
+        /**
+         * @brief The operator * by a number on a temporary graph, it is multiplied in place.
+        **/
+        BasicGraph operator*(W num) &&;
 
         /**
          * @brief This method overloads the operator *= to multiply the graph by a number.
@@ -238,7 +854,7 @@ namespace GraphLib{
          * @return The current graph after the multiplication.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph& operator*=(int num);
+        BasicGraph& operator*=(W num);
 
         /**
          * @brief This method overloads the operator / to divide the graph by a number.
@@ -246,7 +862,12 @@ namespace GraphLib{
          * @return pointer to the new graph that is the division of the current graph by the given number.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph operator/(int num) const;
+        BasicGraph operator/(W num) const &;
+
+        /**
+         * @brief The operator / by a number on a temporary graph, it is divided in place.
+        **/
+        BasicGraph operator/(W num) &&;
 
         /**
          * @brief This method overloads the operator /= to divide the graph by a number.
@@ -254,7 +875,7 @@ namespace GraphLib{
          * @return The current graph after the division.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        Graph& operator/=(int num);
+        BasicGraph& operator/=(W num);
 
         /**
          * @brief This method overloads the operator * to multiply two graphs.
@@ -263,7 +884,7 @@ namespace GraphLib{
          * @throws std::invalid_argument if one of the graphs is not loaded.
          * @throws std::invalid_argument if the given graph can not multiplie the current graph .
         **/
-        Graph operator*(const Graph &g) const;
+        BasicGraph operator*(const BasicGraph &g) const;
 
         /**
          * @brief This method overloads the operator *= to multiply two graphs.
@@ -272,61 +893,108 @@ namespace GraphLib{
          * @throws std::invalid_argument if one of the graphs is not loaded.
          * @throws std::invalid_argument if the given graph can not multiplie the current graph .
         **/
-        Graph& operator*=(const Graph &g);
+        BasicGraph& operator*=(const BasicGraph &g);
+
+        /**
+         * @brief This method multiplies two graphs over a semiring, for example multiply<MinPlus>(g) gives
+         * @brief the lightest walks of length 2. Every semiring has its own compiled kernel on the tiled and
+         * @brief threaded product, PlusTimes is the same as operator * and OrAnd runs on bit rows.
+         * @tparam S PlusTimes, MinPlus, OrAnd or MaxMin (see Semiring.hpp).
+         * @param g The graph to be multiplied by the current graph.
+         * @return The product of the two graphs over the semiring.
+         * @throws std::invalid_argument if one of the graphs is not loaded.
+         * @throws std::invalid_argument if the given graph has different size.
+        **/
+        template<template<typename, typename> class S>
+        BasicGraph multiply(const BasicGraph &g) const;
+
+        /**
+         * @brief This method raises the graph to the power k over a semiring by repeated squaring, so it takes
+         * @brief O(log k) products. The intermediate powers are kept in D and the flags are computed once,
+         * @brief only the result is converted back to W.
+         * @brief power<PlusTimes>(k) counts the walks of length k, power<MinPlus>(k) gives the lightest walks
+         * @brief of exactly k edges and power<OrAnd>(k) tells which vertices are reachable in exactly k steps.
+         * @tparam S The semiring, PlusTimes by default (see Semiring.hpp).
+         * @param k The exponent, the power 0 has the identity of the semiring multiplication on the diagonal.
+         * @return The graph raised to the power k.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        template<template<typename, typename> class S = PlusTimes>
+        BasicGraph power(size_t k) const;
+
+        /**
+         * @brief This method counts the walks of length k modulo a number, every product is reduced so
+         * @brief the counts never overflow. Only integral weights, modulus up to 2^32 and up to 2^15 vertices,
+         * @brief and modulus - 1 has to fit W.
+         * @param k The exponent.
+         * @param modulus The number the counts are reduced by.
+         * @return The graph raised to the power k, every weight in [0, modulus).
+         * @throws std::invalid_argument if the graph is not loaded or the modulus is not supported.
+        **/
+        BasicGraph power(size_t k, D modulus) const;
+
+        /**
+         * @brief This method counts the walks of length k like power(k), but returns the counts with the
+         * @brief weight type D, so they do not overflow W.
+         * @param k The exponent.
+         * @return The graph raised to the power k with D weights.
+         * @throws std::invalid_argument if the graph is not loaded.
+        **/
+        BasicGraph<D> widePower(size_t k) const;
 
         /**
          * @brief  This method overloads the operator == to compare two graphs.
+         * @brief Graphs of different sizes, edge counts or fingerprints are rejected in O(1) once their fingerprints
+         * @brief are cached, the matrices are only compared when all of them match.
          * @param g The graph to be compared to the current graph.
          * @return true if the two graphs are equal, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
-         * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        bool operator==(const Graph &g) const;
+        bool operator==(const BasicGraph &g) const;
         
         /**
          * @brief This method overloads the operator != to compare two graphs.
          * @param g The graph to be compared to the current graph.
          * @return true if the two graphs are not equal, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
-         * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        bool operator!=(const Graph &g) const;
+        bool operator!=(const BasicGraph &g) const;
 
         /**
          * @brief This method overloads the operator < to compare two graphs.
+         * @brief Graphs are ordered by their number of edges, then by their number of vertices, which also puts every
+         * @brief strict subgraph before the graphs that contain it. Graphs that tie on both are ordered by a hash of
+         * @brief their content and, if the hashes tie too, by their matrices, so different graphs are never equivalent.
+         * @brief The key of every graph is computed once and cached until the graph changes.
          * @param g The graph to be compared to the current graph.
          * @return true if the current graph is less than the given graph, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
-         * @throws std::invalid_argument if the given graph is not the same size as the current graph. 
         **/
-        bool operator<(const Graph &g) const;
+        bool operator<(const BasicGraph &g) const;
 
         /**
          * @brief This method overloads the operator <= to compare two graphs.
          * @param g The graph to be compared to the current graph.
          * @return true if the current graph is less than or equal to the given graph, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
-         * @throws std::invalid_argument if the given graph is not the same size as the current graph. 
         **/
-        bool operator<=(const Graph &g) const;
+        bool operator<=(const BasicGraph &g) const;
 
         /**
          * @brief This method overloads the operator > to compare two graphs.
          * @param g The graph to be compared to the current graph.
          * @return true if the current graph is greater than the given graph, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
-         * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        bool operator>(const Graph &g) const;
+        bool operator>(const BasicGraph &g) const;
 
         /**
          * @brief This method overloads the operator >= to compare two graphs.
          * @param g The graph to be compared to the current graph.
          * @return true if the current graph is greater than or equal to the given graph, false otherwise.
          * @throws std::invalid_argument if one of the graphs is not loaded.
-         * @throws std::invalid_argument if the given graph is not the same size as the current graph.
         **/
-        bool operator>=(const Graph &g) const;
+        bool operator>=(const BasicGraph &g) const;
 
         /**
          * @brief This method overloads the operator << to print the graph.
@@ -335,7 +1003,33 @@ namespace GraphLib{
          * @return The output stream after printing the graph.
          * @throws std::invalid_argument if the graph is not loaded.
         **/
-        friend std::ostream& operator<<(std::ostream& os, const Graph &g);
+        friend std::ostream& operator<< <>(std::ostream& os, const BasicGraph &g);
 
     };
-};
\ No newline at end of file
+
+    /**
+     * @brief The graph with int weights, the type the library was originally written for.
+    **/
+    typedef BasicGraph<int> Graph;
+
+    /**
+     * @brief Multiplies two graphs over the semiring S, the same as a.multiply<S>(b).
+    **/
+    template<template<typename, typename> class S, typename W, typename D>
+    BasicGraph<W, D> multiply(const BasicGraph<W, D> &a, const BasicGraph<W, D> &b) {
+        return a.template multiply<S>(b);
+    }
+};
+
+namespace std{
+    /**
+     * @brief Hashes graphs by their fingerprint, so they can be used as keys of unordered containers.
+    **/
+    template<typename W, typename D>
+    struct hash<GraphLib::BasicGraph<W, D>> {
+        size_t operator()(const GraphLib::BasicGraph<W, D> &g) const {return static_cast<size_t>(g.hash());}
+    };
+}
+
+#include "GraphExpr.hpp"
+#include "Semiring.hpp"
\ No newline at end of file
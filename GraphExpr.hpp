@@ -0,0 +1,193 @@
+#include <memory>
+#pragma once
+
+// This header is included at the end of Graph.hpp and is not meant to be included on its own.
+
+namespace GraphLib{
+
+    /**
+     * @brief Keeps a template argument out of type deduction, so a scalar like 2 can be used with float graphs.
+    **/
+    template<typename T>
+    struct Identity {
+        typedef T type;
+    };
+
+    /**
+     * @class GraphExpr
+     * @brief The base of every lazy elementwise graph expression.
+     * @brief An expression only records its operands, nothing is computed until it is assigned to a graph,
+     * @brief then the whole expression is computed in a single pass over the matrix and the flags are computed once.
+     * @brief The operand graphs must not change or be destroyed before the expression is assigned.
+     * @tparam E The concrete expression type.
+     * @tparam W The type of the edge weights.
+    **/
+    template<typename E, typename W>
+    class GraphExpr {
+        public:
+        const E& self() const {return static_cast<const E&>(*this);}
+    };
+
+    /**
+     * @class GraphLeaf
+     * @brief A graph used as an operand of an expression.
+     * @brief A sparse, bitset or packed graph is expanded once into a shared buffer, a dense graph is read in place.
+     * @throws std::invalid_argument if the graph is not loaded.
+    **/
+    template<typename W, typename D>
+    class GraphLeaf : public GraphExpr<GraphLeaf<W, D>, W> {
+        private:
+        std::shared_ptr<typename BasicGraph<W, D>::Matrix> buffer;
+        const W *data;
+        size_t len;
+        public:
+        explicit GraphLeaf(const BasicGraph<W, D> &g) {
+            if(!g.isLoaded()){throw std::invalid_argument("The graph is not loaded.");}
+            buffer = std::make_shared<typename BasicGraph<W, D>::Matrix>();
+            data = g.denseData(*buffer);
+            len = g.getNumVertices();
+        }
+        size_t getNumVertices() const {return len;}
+        W operator[](size_t k) const {return data[k];}
+    };
+
+    struct AddOp {
+        template<typename W> static W apply(W a, W b) {return static_cast<W>(a + b);}
+    };
+
+    struct SubOp {
+        template<typename W> static W apply(W a, W b) {return static_cast<W>(a - b);}
+    };
+
+    struct MulOp {
+        template<typename W> static W apply(W a, W b) {return static_cast<W>(a * b);}
+    };
+
+    struct DivOp {
+        template<typename W> static W apply(W a, W b) {return static_cast<W>(a / b);}
+    };
+
+    /**
+     * @class GraphBinaryExpr
+     * @brief Cell by cell operation between two expressions of the same size.
+     * @throws std::invalid_argument if the operands have a different number of vertices.
+    **/
+    template<typename L, typename R, typename Op, typename W>
+    class GraphBinaryExpr : public GraphExpr<GraphBinaryExpr<L, R, Op, W>, W> {
+        private:
+        L left;
+        R right;
+        public:
+        GraphBinaryExpr(const L &left, const R &right) : left(left), right(right) {
+            if(left.getNumVertices() != right.getNumVertices()){
+                throw std::invalid_argument("The given graph has different size.");
+            }
+        }
+        size_t getNumVertices() const {return left.getNumVertices();}
+        W operator[](size_t k) const {return Op::apply(left[k], right[k]);}
+    };
+
+    /**
+     * @class GraphScalarExpr
+     * @brief Cell by cell operation between an expression and a number.
+    **/
+    template<typename E, typename Op, typename W>
+    class GraphScalarExpr : public GraphExpr<GraphScalarExpr<E, Op, W>, W> {
+        private:
+        E expr;
+        W scalar;
+        public:
+        GraphScalarExpr(const E &expr, W scalar) : expr(expr), scalar(scalar) {}
+        size_t getNumVertices() const {return expr.getNumVertices();}
+        W operator[](size_t k) const {return Op::apply(expr[k], scalar);}
+    };
+
+    /**
+     * @class GraphNegateExpr
+     * @brief The negation of every cell of an expression.
+    **/
+    template<typename E, typename W>
+    class GraphNegateExpr : public GraphExpr<GraphNegateExpr<E, W>, W> {
+        private:
+        E expr;
+        public:
+        explicit GraphNegateExpr(const E &expr) : expr(expr) {}
+        size_t getNumVertices() const {return expr.getNumVertices();}
+        W operator[](size_t k) const {return static_cast<W>(-expr[k]);}
+    };
+
+    /**
+     * @brief Starts a lazy expression, for example g = lazy(g1) + g2 * 3 - g3 is computed in one pass.
+     * @param g The graph to be used as an operand.
+     * @return The graph wrapped as an expression.
+     * @throws std::invalid_argument if the graph is not loaded.
+    **/
+    template<typename W, typename D>
+    GraphLeaf<W, D> lazy(const BasicGraph<W, D> &g) {
+        return GraphLeaf<W, D>(g);
+    }
+
+    // The binary operators, an expression can be combined with another expression or with a graph on either side.
+    #define GRAPHLIB_EXPR_BINARY(OP, OPTYPE) \
+    template<typename L, typename R, typename W> \
+    GraphBinaryExpr<L, R, OPTYPE, W> operator OP(const GraphExpr<L, W> &l, const GraphExpr<R, W> &r) { \
+        return GraphBinaryExpr<L, R, OPTYPE, W>(l.self(), r.self()); \
+    } \
+    template<typename L, typename W, typename D> \
+    GraphBinaryExpr<L, GraphLeaf<W, D>, OPTYPE, W> operator OP(const GraphExpr<L, W> &l, const BasicGraph<W, D> &r) { \
+        return GraphBinaryExpr<L, GraphLeaf<W, D>, OPTYPE, W>(l.self(), GraphLeaf<W, D>(r)); \
+    } \
+    template<typename R, typename W, typename D> \
+    GraphBinaryExpr<GraphLeaf<W, D>, R, OPTYPE, W> operator OP(const BasicGraph<W, D> &l, const GraphExpr<R, W> &r) { \
+        return GraphBinaryExpr<GraphLeaf<W, D>, R, OPTYPE, W>(GraphLeaf<W, D>(l), r.self()); \
+    }
+
+    GRAPHLIB_EXPR_BINARY(+, AddOp)
+    GRAPHLIB_EXPR_BINARY(-, SubOp)
+    #undef GRAPHLIB_EXPR_BINARY
+
+    template<typename E, typename W>
+    GraphScalarExpr<E, MulOp, W> operator*(const GraphExpr<E, W> &e, typename Identity<W>::type scalar) {
+        return GraphScalarExpr<E, MulOp, W>(e.self(), scalar);
+    }
+
+    /**
+     * @throws std::invalid_argument if the scalar value is zero.
+    **/
+    template<typename E, typename W>
+    GraphScalarExpr<E, DivOp, W> operator/(const GraphExpr<E, W> &e, typename Identity<W>::type scalar) {
+        if(scalar == 0){
+            throw std::invalid_argument("The scalar value is zero.");
+        }
+        return GraphScalarExpr<E, DivOp, W>(e.self(), scalar);
+    }
+
+    template<typename E, typename W>
+    GraphNegateExpr<E, W> operator-(const GraphExpr<E, W> &e) {
+        return GraphNegateExpr<E, W>(e.self());
+    }
+
+    /*
+     Computes the expression cell by cell into a new buffer, so the expression may also read the graph
+     it is assigned to, then loads the buffer which computes the flags once.
+    */
+    template<typename W, typename D>
+    template<typename E>
+    BasicGraph<W, D>& BasicGraph<W, D>::operator=(const GraphExpr<E, W> &expr) {
+        const E &e = expr.self();
+        size_t len = e.getNumVertices();
+        size_t cells = len * len;
+        Matrix temp(cells);
+        for(size_t k = 0; k < cells; k++){
+            temp[k] = e[k];
+        }
+        this->loadMatrix(len, std::move(temp));
+        return *this;
+    }
+
+    template<typename W, typename D>
+    template<typename E>
+    BasicGraph<W, D>::BasicGraph(const GraphExpr<E, W> &expr) : BasicGraph() {
+        *this = expr;
+    }
+}
@@ -0,0 +1,258 @@
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+#pragma once
+
+namespace GraphLib{
+
+        namespace Heaps{
+                // Marks a missing node of a pairing heap.
+                const size_t NIL = static_cast<size_t>(-1);
+
+                /**
+                 * @brief The priority queues of Dijkstra's algorithm hold vertices and read their keys (the tentative
+                 * @brief distances) from a vector owned by the caller. Every queue pops the vertex with the smallest key,
+                 * @brief the smallest vertex among equal keys, so the vertices are settled in the same order by all of them.
+                 * @brief A key may only be lowered, and decrease(v) has to be called right after keys[v] was lowered.
+                **/
+
+                /**
+                 * @class DaryHeap
+                 * @brief An indexed 4-ary heap. Every vertex knows its position, so decrease moves it up in place,
+                 * @brief and the 4 children of a node share a cache line, which keeps the heap shallow.
+                **/
+                template<typename K>
+                class DaryHeap {
+                        private:
+                        static const size_t ARITY = 4;
+                        const std::vector<K> &keys;
+                        std::vector<size_t> heap;
+                        std::vector<size_t> pos;
+                        bool less(size_t a, size_t b) const {return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);}
+                        void up(size_t i){
+                                size_t v = heap[i];
+                                while(i > 0){
+                                        size_t parent = (i - 1) / ARITY;
+                                        if(!less(v, heap[parent])){
+                                                break;
+                                        }
+                                        heap[i] = heap[parent];
+                                        pos[heap[i]] = i;
+                                        i = parent;
+                                }
+                                heap[i] = v;
+                                pos[v] = i;
+                        }
+                        void down(size_t i){
+                                size_t v = heap[i];
+                                size_t n = heap.size();
+                                while(i * ARITY + 1 < n){
+                                        size_t first = i * ARITY + 1;
+                                        size_t best = first;
+                                        for(size_t c = first + 1; c < std::min(first + ARITY, n); c++){
+                                                if(less(heap[c], heap[best])){
+                                                        best = c;
+                                                }
+                                        }
+                                        if(!less(heap[best], v)){
+                                                break;
+                                        }
+                                        heap[i] = heap[best];
+                                        pos[heap[i]] = i;
+                                        i = best;
+                                }
+                                heap[i] = v;
+                                pos[v] = i;
+                        }
+                        public:
+                        DaryHeap(const std::vector<K> &keys) : keys(keys), pos(keys.size()) {}
+                        bool empty() const {return heap.empty();}
+                        void push(size_t v){
+                                heap.push_back(v);
+                                up(heap.size() - 1);
+                        }
+                        void decrease(size_t v) {up(pos[v]);}
+                        size_t pop(){
+                                size_t top = heap[0];
+                                size_t last = heap.back();
+                                heap.pop_back();
+                                if(!heap.empty()){
+                                        heap[0] = last;
+                                        down(0);
+                                }
+                                return top;
+                        }
+                };
+
+                /**
+                 * @class PairingHeap
+                 * @brief A pairing heap with a node per vertex. push and decrease meld a single tree into the root in O(1),
+                 * @brief pop melds the children of the root in two passes, in amortized O(log n).
+                **/
+                template<typename K>
+                class PairingHeap {
+                        private:
+                        struct Node {
+                                size_t child;
+                                size_t next;
+                                size_t prev; // the left sibling, or the parent of a first child
+                        };
+                        const std::vector<K> &keys;
+                        std::vector<Node> nodes;
+                        std::vector<size_t> pairs;
+                        size_t root;
+                        bool less(size_t a, size_t b) const {return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);}
+                        // melds two trees, the root with the larger key becomes the first child of the other one
+                        size_t meld(size_t a, size_t b){
+                                if(a == NIL || b == NIL){
+                                        return a == NIL ? b : a;
+                                }
+                                if(less(b, a)){
+                                        std::swap(a, b);
+                                }
+                                nodes[b].next = nodes[a].child;
+                                if(nodes[a].child != NIL){
+                                        nodes[nodes[a].child].prev = b;
+                                }
+                                nodes[b].prev = a;
+                                nodes[a].child = b;
+                                return a;
+                        }
+                        public:
+                        PairingHeap(const std::vector<K> &keys) : keys(keys), nodes(keys.size()), root(NIL) {}
+                        bool empty() const {return root == NIL;}
+                        void push(size_t v){
+                                nodes[v] = Node{NIL, NIL, NIL};
+                                root = meld(root, v);
+                        }
+                        void decrease(size_t v){
+                                if(v == root){
+                                        return;
+                                }
+                                // cut the subtree of v and meld it into the root
+                                Node &node = nodes[v];
+                                if(nodes[node.prev].child == v){
+                                        nodes[node.prev].child = node.next;
+                                }
+                                else{
+                                        nodes[node.prev].next = node.next;
+                                }
+                                if(node.next != NIL){
+                                        nodes[node.next].prev = node.prev;
+                                }
+                                node.next = NIL;
+                                node.prev = NIL;
+                                root = meld(root, v);
+                        }
+                        size_t pop(){
+                                size_t top = root;
+                                // first pass, meld the children in pairs from left to right
+                                pairs.clear();
+                                for(size_t c = nodes[top].child; c != NIL;){
+                                        size_t second = nodes[c].next;
+                                        size_t after = second == NIL ? NIL : nodes[second].next;
+                                        nodes[c].next = nodes[c].prev = NIL;
+                                        if(second != NIL){
+                                                nodes[second].next = nodes[second].prev = NIL;
+                                        }
+                                        pairs.push_back(meld(c, second));
+                                        c = after;
+                                }
+                                // second pass, meld the pairs from right to left
+                                root = NIL;
+                                for(size_t k = pairs.size(); k > 0; k--){
+                                        root = meld(pairs[k - 1], root);
+                                }
+                                return top;
+                        }
+                };
+
+                /**
+                 * @class RadixHeap
+                 * @brief A monotone queue for non-negative integral keys, keys pushed after a pop are never smaller than the
+                 * @brief popped key. A key is kept in the bucket of the highest bit in which it differs from the last popped
+                 * @brief key, so every entry moves down at most 64 times. decrease pushes the vertex again and the old
+                 * @brief entry is popped later with a larger key, the caller skips the vertices it already settled.
+                **/
+                template<typename K>
+                class RadixHeap {
+                        private:
+                        const std::vector<K> &keys;
+                        std::vector<std::pair<uint64_t, size_t>> buckets[65];
+                        uint64_t last;
+                        size_t count;
+                        size_t bucket(uint64_t key) const {return key == last ? 0 : 64 - (size_t)__builtin_clzll(key ^ last);}
+                        public:
+                        RadixHeap(const std::vector<K> &keys) : keys(keys), last(0), count(0) {}
+                        bool empty() const {return count == 0;}
+                        void push(size_t v){
+                                uint64_t key = static_cast<uint64_t>(keys[v]);
+                                buckets[bucket(key)].push_back(std::make_pair(key, v));
+                                count++;
+                        }
+                        void decrease(size_t v) {push(v);}
+                        size_t pop(){
+                                if(buckets[0].empty()){
+                                        // the smallest key becomes the last one and its bucket is spread over the lower buckets
+                                        size_t i = 1;
+                                        while(buckets[i].empty()){
+                                                i++;
+                                        }
+                                        std::vector<std::pair<uint64_t, size_t>> &from = buckets[i];
+                                        last = std::min_element(from.begin(), from.end())->first;
+                                        for(size_t k = 0; k < from.size(); k++){
+                                                buckets[bucket(from[k].first)].push_back(from[k]);
+                                        }
+                                        from.clear();
+                                        // only the spread fills bucket 0, the smallest vertex is popped first
+                                        std::sort(buckets[0].begin(), buckets[0].end(), std::greater<std::pair<uint64_t, size_t>>());
+                                }
+                                size_t v = buckets[0].back().second;
+                                buckets[0].pop_back();
+                                count--;
+                                return v;
+                        }
+                };
+
+                /**
+                 * @class BucketQueue
+                 * @brief Dial's circular bucket array for non-negative integral keys, given the largest edge weight C.
+                 * @brief The keys in the queue are never more than C apart, so C + 1 buckets indexed by the key modulo C + 1
+                 * @brief hold one key each, and pop walks the buckets in order. Like the radix heap, decrease pushes the
+                 * @brief vertex again. The edges must weigh at least 1, so a pop never adds to the bucket it is popping.
+                **/
+                template<typename K>
+                class BucketQueue {
+                        private:
+                        const std::vector<K> &keys;
+                        std::vector<std::vector<size_t>> buckets;
+                        size_t cursor;
+                        size_t count;
+                        public:
+                        BucketQueue(const std::vector<K> &keys, uint64_t maxWeight)
+                            : keys(keys), buckets(static_cast<size_t>(maxWeight) + 1), cursor(0), count(0) {}
+                        bool empty() const {return count == 0;}
+                        void push(size_t v){
+                                buckets[static_cast<size_t>(static_cast<uint64_t>(keys[v]) % buckets.size())].push_back(v);
+                                count++;
+                        }
+                        void decrease(size_t v) {push(v);}
+                        size_t pop(){
+                                if(buckets[cursor].empty()){
+                                        do{
+                                                cursor = cursor + 1 == buckets.size() ? 0 : cursor + 1;
+                                        } while(buckets[cursor].empty());
+                                        // the smallest vertex is popped first
+                                        std::sort(buckets[cursor].begin(), buckets[cursor].end(), std::greater<size_t>());
+                                }
+                                size_t v = buckets[cursor].back();
+                                buckets[cursor].pop_back();
+                                count--;
+                                return v;
+                        }
+                };
+        }
+}
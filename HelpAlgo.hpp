@@ -11,17 +11,20 @@ namespace GraphLib
 
    /**
     * @brief This function is a helper function that runs the BFS algorithm on the graph.
-    * @brief The vectors should be given after the initialization, the distance vector should have the value of INT_MAX,
+    * @brief The vectors should be given after the initialization, the distance vector should have the value of infinity<D>(),
        the predecessor vector should have the value of -1 and color vector should have the value of WHITE.
     * @param g The graph to be traversed.
     * @param src The source vertex.
     * @param dis The distance vector.
     * @param pre The predecessor vector.
     * @param col The color vector.
+    * @param policy Whether the large levels are expanded on all the hardware threads.
     * @return void, value will be stored in the given vectors.
     * @throws std::invalid_argument if the graph is not loaded.
    **/
-   void BFS(const Graph &g, size_t src, std::vector<int> &dis, std::vector<int> &pre, std::vector<int> &col);
+   template<typename W, typename D>
+   void BFS(const BasicGraph<W, D> &g, size_t src, std::vector<D> &dis, std::vector<int> &pre, std::vector<int> &col,
+            Algorithms::Execution policy = Algorithms::SEQUENTIAL);
    
    /**
     * @brief This function is a helper function that runs the outer loop of the DFS algorithm on the graph.
@@ -35,7 +38,8 @@ namespace GraphLib
     * @return void, value will be stored in the given vectors.
     * @throws std::invalid_argument if the graph is not loaded.
    **/
-   void DFS(const Graph &g, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &dis, std::vector<int> &fin);
+   template<typename W, typename D>
+   void DFS(const BasicGraph<W, D> &g, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &dis, std::vector<int> &fin);
    
    /**
     * @brief This function is a helper function that runs the inner loop of the DFS algorithm on the graph.
@@ -47,7 +51,8 @@ namespace GraphLib
     * @param fin The finish time vector.
     * @return void, value will be stored in the given vectors.
    **/
-   void DFS_VISIT(const Graph &g, size_t v, std::vector<int> &col, std::vector<int> &pre, int &time,std::vector<int> &dis, std::vector<int> &fin); 
+   template<typename W, typename D>
+   void DFS_VISIT(const BasicGraph<W, D> &g, size_t v, std::vector<int> &col, std::vector<int> &pre, int &time,std::vector<int> &dis, std::vector<int> &fin); 
 
    /**
     * @brief This function is a helper function that runs a modified DFS algorithm to detect cycles in the graph.
@@ -61,7 +66,8 @@ namespace GraphLib
     * @return void, value will be stored in the given vectors,
       if a cycle is detected then the cycle vector will contain two vertices that are part of the cycle.
    **/
-   void DFSDetectCycle(const Graph &g, size_t v, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &cycle);
+   template<typename W, typename D>
+   void DFSDetectCycle(const BasicGraph<W, D> &g, size_t v, std::vector<int> &col, std::vector<int> &pre, std::vector<int> &cycle);
 
    /**
     * @brief This function is a helper function that relaxes the edges of the graph.
@@ -72,24 +78,31 @@ namespace GraphLib
     * @param pre The predecessor vector.
     * @return void, value will be stored in the given vectors.
    **/
-   void relax(size_t u, size_t v, int weight, std::vector<int> &dis, std::vector<int> &pre);
+   template<typename W, typename D>
+   void relax(size_t u, size_t v, W weight, std::vector<D> &dis, std::vector<int> &pre);
 
    /**
     * @brief This function is a helper function that runs the Dijkstra algorithm on the graph.
-    * @brief The vectors should be given after the initialization, the distance vector should have the value of INT_MAX,
-       the predecessor vector should have the value of -1 and the distance vector need one vector to be initialized with starting value 0.
+    * @brief The vectors should be given after the initialization, the distance vector should have the value of infinity<D>()
+       and the predecessor vector should have the value of -1. The weights must not be negative.
     * @param g The graph to be traversed.
     * @param src The source vertex.   
     * @param dis The distance vector.
     * @param pre The predecessor vector.
+    * @param heap The priority queue that picks the next vertex to settle.
+    * @param dst The search stops once this vertex is settled, the distances and predecessors of the vertices
+       settled later may be left too large or unset, only dst and the vertices on its path are final and match a
+       full search. By default every reachable vertex is settled.
     * @return void, value will be stored in the given vectors.
     * @throws std::invalid_argument if the graph is not loaded.
    **/
-   void Dijkstra(const Graph &g, size_t src, std::vector<int> &dis, std::vector<int> &pre);
+   template<typename W, typename D>
+   void Dijkstra(const BasicGraph<W, D> &g, size_t src, std::vector<D> &dis, std::vector<int> &pre,
+                 Algorithms::Heap heap = Algorithms::AUTO_HEAP, size_t dst = std::numeric_limits<size_t>::max());
    
    /** 
     * @brief This function is a helper function that runs the Bellman-Ford algorithm on the graph.
-    * @brief The vectors should be given after the initialization, the distance vector should have the value of INT_MAX
+    * @brief The vectors should be given after the initialization, the distance vector should have the value of infinity<D>()
        and the predecessor vector should have the value of -1. The distance vector need one vector to be initialized with starting value 0.
     * @param g The graph to be traversed.
     * @param dis The distance vector.
@@ -99,7 +112,8 @@ namespace GraphLib
       if a negative cycle is detected then the cycle vector will contain TWO vertices that are part of the cycle.
     * @throws std::invalid_argument if the graph is not loaded.  
    **/
-   bool bellmanFord(const Graph &g, std::vector<int> &dis, std::vector<int> &pre, std::vector<int> &cycle);
+   template<typename W, typename D>
+   bool bellmanFord(const BasicGraph<W, D> &g, std::vector<D> &dis, std::vector<int> &pre, std::vector<int> &cycle);
    
    /**
     * @brief Given a path in a string format return a vector that represent the 
@@ -0,0 +1,174 @@
+#include "Graph.hpp"
+#include "Kernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define GRAPHLIB_X86_KERNELS
+#endif
+
+namespace{
+    using GraphLib::Kernels::Op;
+    using GraphLib::Kernels::Level;
+    using GraphLib::Kernels::Flags;
+
+    template<typename W, size_t BYTES>
+    struct Vector {
+        typedef W type __attribute__((vector_size(BYTES)));
+    };
+
+    template<typename W, Op OP>
+    inline W combine(W x, W y){
+        switch(OP){
+            case GraphLib::Kernels::ADD: return static_cast<W>(x + y);
+            case GraphLib::Kernels::SUB: return static_cast<W>(x - y);
+            case GraphLib::Kernels::MUL: return static_cast<W>(x * y);
+            default: return static_cast<W>(x / y);
+        }
+    }
+
+    /*
+     The scalar kernel, also used for the tail of the vector kernels.
+     The flags are collected while the values are written, so the matrix is read only once.
+    */
+    template<typename W, Op OP, bool BROADCAST>
+    Flags scalarLoop(const W *a, const W *b, W scalar, W *out, size_t begin, size_t n){
+        bool neg = false;
+        bool big = false;
+        for(size_t k = begin; k < n; k++){
+            W value = combine<W, OP>(a[k], BROADCAST ? scalar : b[k]);
+            out[k] = value;
+            neg = neg || value < 0;
+            big = big || value > 1;
+        }
+        return Flags{neg, neg || big};
+    }
+
+#ifdef GRAPHLIB_X86_KERNELS
+    /*
+     The vector kernel, BYTES bytes of every operand per step with unaligned loads and stores.
+     It is always inlined into a function compiled for the matching instruction set, so the vector
+     operations are lowered to that instruction set. The negative and greater than 1 lanes are
+     or-ed into masks and reduced once at the end.
+    */
+    template<typename W, size_t BYTES, Op OP, bool BROADCAST>
+    inline __attribute__((always_inline))
+    Flags vectorLoop(const W *a, const W *b, W scalar, W *out, size_t n){
+        typedef typename Vector<W, BYTES>::type V;
+        typedef decltype(V() < V()) Mask;
+        const size_t LANES = BYTES / sizeof(W);
+        const V zero = V();
+        const V one = zero + static_cast<W>(1);
+        const V right = zero + scalar;
+        Mask neg = Mask();
+        Mask big = Mask();
+        size_t k = 0;
+        for(; k + LANES <= n; k += LANES){
+            V x, y, value;
+            __builtin_memcpy(&x, a + k, BYTES);
+            if(BROADCAST){
+                y = right;
+            }
+            else{
+                __builtin_memcpy(&y, b + k, BYTES);
+            }
+            switch(OP){
+                case GraphLib::Kernels::ADD: value = x + y; break;
+                case GraphLib::Kernels::SUB: value = x - y; break;
+                case GraphLib::Kernels::MUL: value = x * y; break;
+                default: value = x / y; break;
+            }
+            __builtin_memcpy(out + k, &value, BYTES);
+            neg |= value < zero;
+            big |= value > one;
+        }
+        Flags flags = scalarLoop<W, OP, BROADCAST>(a, b, scalar, out, k, n);
+        for(size_t i = 0; i < LANES; i++){
+            flags.negValues = flags.negValues || neg[i] != 0;
+            flags.weighted = flags.weighted || neg[i] != 0 || big[i] != 0;
+        }
+        return flags;
+    }
+
+    template<typename W, Op OP, bool BROADCAST>
+    __attribute__((target("sse4.1")))
+    Flags sse4Loop(const W *a, const W *b, W scalar, W *out, size_t n){
+        return vectorLoop<W, 16, OP, BROADCAST>(a, b, scalar, out, n);
+    }
+
+    template<typename W, Op OP, bool BROADCAST>
+    __attribute__((target("avx2")))
+    Flags avx2Loop(const W *a, const W *b, W scalar, W *out, size_t n){
+        return vectorLoop<W, 32, OP, BROADCAST>(a, b, scalar, out, n);
+    }
+
+    template<typename W, Op OP, bool BROADCAST>
+    __attribute__((target("avx512f,avx512bw")))
+    Flags avx512Loop(const W *a, const W *b, W scalar, W *out, size_t n){
+        return vectorLoop<W, 64, OP, BROADCAST>(a, b, scalar, out, n);
+    }
+#endif
+
+    Level detectLevel(){
+#ifdef GRAPHLIB_X86_KERNELS
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512dq")){
+            return GraphLib::Kernels::AVX512;
+        }
+        if(__builtin_cpu_supports("avx2")){
+            return GraphLib::Kernels::AVX2;
+        }
+        if(__builtin_cpu_supports("sse4.1")){
+            return GraphLib::Kernels::SSE4;
+        }
+#endif
+        return GraphLib::Kernels::SCALAR;
+    }
+
+    const Level SUPPORTED = detectLevel();
+    Level current = SUPPORTED;
+
+    template<typename W, Op OP, bool BROADCAST>
+    Flags dispatch(const W *a, const W *b, W scalar, W *out, size_t n){
+        switch(current){
+#ifdef GRAPHLIB_X86_KERNELS
+            case GraphLib::Kernels::AVX512: return avx512Loop<W, OP, BROADCAST>(a, b, scalar, out, n);
+            case GraphLib::Kernels::AVX2: return avx2Loop<W, OP, BROADCAST>(a, b, scalar, out, n);
+            case GraphLib::Kernels::SSE4: return sse4Loop<W, OP, BROADCAST>(a, b, scalar, out, n);
+#endif
+            default: return scalarLoop<W, OP, BROADCAST>(a, b, scalar, out, 0, n);
+        }
+    }
+
+    template<typename W, bool BROADCAST>
+    Flags dispatch(Op op, const W *a, const W *b, W scalar, W *out, size_t n){
+        switch(op){
+            case GraphLib::Kernels::ADD: return dispatch<W, GraphLib::Kernels::ADD, BROADCAST>(a, b, scalar, out, n);
+            case GraphLib::Kernels::SUB: return dispatch<W, GraphLib::Kernels::SUB, BROADCAST>(a, b, scalar, out, n);
+            case GraphLib::Kernels::MUL: return dispatch<W, GraphLib::Kernels::MUL, BROADCAST>(a, b, scalar, out, n);
+            default: return dispatch<W, GraphLib::Kernels::DIV, BROADCAST>(a, b, scalar, out, n);
+        }
+    }
+}
+
+GraphLib::Kernels::Level GraphLib::Kernels::getLevel(){
+    return current;
+}
+
+GraphLib::Kernels::Level GraphLib::Kernels::setLevel(Level level){
+    current = level < SUPPORTED ? level : SUPPORTED;
+    return current;
+}
+
+template<typename W>
+GraphLib::Kernels::Flags GraphLib::Kernels::apply(Op op, const W *a, const W *b, W *out, size_t n){
+    return dispatch<W, false>(op, a, b, W(), out, n);
+}
+
+template<typename W>
+GraphLib::Kernels::Flags GraphLib::Kernels::apply(Op op, const W *a, W scalar, W *out, size_t n){
+    return dispatch<W, true>(op, a, nullptr, scalar, out, n);
+}
+
+#define GRAPHLIB_INSTANTIATE_KERNELS(W) \
+    template GraphLib::Kernels::Flags GraphLib::Kernels::apply(Op op, const W *a, const W *b, W *out, size_t n); \
+    template GraphLib::Kernels::Flags GraphLib::Kernels::apply(Op op, const W *a, W scalar, W *out, size_t n);
+GRAPHLIB_FOR_EACH_WEIGHT(GRAPHLIB_INSTANTIATE_KERNELS)
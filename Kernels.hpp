@@ -0,0 +1,55 @@
+#include <cstddef>
+#pragma once
+
+namespace GraphLib{
+
+        namespace Kernels{
+                /**
+                 * @brief The elementwise operations the kernels compute, out[k] = a[k] op b[k].
+                **/
+                enum Op{ADD, SUB, MUL, DIV};
+
+                /**
+                 * @brief The instruction sets the kernels are compiled for.
+                 * @brief The best one supported by the cpu is detected once at runtime, SCALAR is always available.
+                **/
+                enum Level{SCALAR, SSE4, AVX2, AVX512};
+
+                /**
+                 * @brief The graph flags of the values written by a kernel, computed in the same pass.
+                **/
+                struct Flags {
+                        bool negValues;
+                        bool weighted;
+                };
+
+                /**
+                 * @return The instruction set the kernels currently run on.
+                **/
+                Level getLevel();
+
+                /**
+                 * @brief Selects the instruction set the kernels run on, a level the cpu does not support
+                 * @brief is lowered to the best supported one.
+                 * @param level The requested instruction set.
+                 * @return The instruction set that was selected.
+                **/
+                Level setLevel(Level level);
+
+                /**
+                 * @brief Computes out[k] = a[k] op b[k] for every k < n.
+                 * @brief out may be the same buffer as a or b, the caller checks the division by zero.
+                 * @return Whether a negative value or a value greater than 1 was written.
+                **/
+                template<typename W>
+                Flags apply(Op op, const W *a, const W *b, W *out, size_t n);
+
+                /**
+                 * @brief Computes out[k] = a[k] op scalar for every k < n.
+                 * @brief out may be the same buffer as a, the caller checks the division by zero.
+                 * @return Whether a negative value or a value greater than 1 was written.
+                **/
+                template<typename W>
+                Flags apply(Op op, const W *a, W scalar, W *out, size_t n);
+        }
+}
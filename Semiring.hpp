@@ -0,0 +1,87 @@
+#include <limits>
+#include <algorithm>
+#pragma once
+
+namespace GraphLib{
+
+    /**
+     * @brief The semirings a product of two graphs can be computed over, see BasicGraph::multiply.
+     * @brief A semiring over the accumulator type D gives the identities of its addition (zero) and of its
+     * @brief multiplication (one, used on the diagonal of the 0th power), computes
+     * @brief acc = acc + x * y with its own addition and multiplication (multiplyAdd, applied to single values of D
+     * @brief and to whole vectors of D, so it takes references only), and converts weights into accumulators
+     * @brief (load) and back (store). NO_EDGE is loaded as zero and zero is stored as NO_EDGE.
+     * @tparam W The type of the edge weights.
+     * @tparam D The type of the accumulators.
+    **/
+
+    /**
+     * @struct PlusTimes
+     * @brief The ordinary (+, *) semiring, the product counts (weighted) walks of length 2.
+    **/
+    template<typename W, typename D>
+    struct PlusTimes {
+        static D zero() {return D(0);}
+        static D one() {return D(1);}
+        template<typename T> static void multiplyAdd(T &acc, const T &x, const T &y) {acc += x * y;}
+        static D load(W w) {return static_cast<D>(w);}
+        static W store(D d) {return static_cast<W>(d);}
+    };
+
+    /**
+     * @struct MinPlus
+     * @brief The (min, +) semiring, the product is the lightest walk of length 2.
+     * @brief A walk of total weight 0 can not be told apart from a missing one and is stored as NO_EDGE.
+    **/
+    template<typename W, typename D>
+    struct MinPlus {
+        static D zero() {return std::numeric_limits<D>::max();}
+        static D one() {return D(0);}
+        template<typename T> static void multiplyAdd(T &acc, const T &x, const T &y) {
+            const T none = T() + zero();
+            // the lanes of a vector are all added, so the missing operands are added as 0 and then replaced by none
+            const auto missing = (x == none) | (y == none);
+            const T sum = missing ? none : (missing ? T() : x) + (missing ? T() : y);
+            acc = acc < sum ? acc : sum;
+        }
+        static D load(W w) {return w == NO_EDGE ? zero() : static_cast<D>(w);}
+        static W store(D d) {return d == zero() ? W(NO_EDGE) : static_cast<W>(d);}
+    };
+
+    /**
+     * @struct OrAnd
+     * @brief The boolean (or, and) semiring, the product tells which vertices are reachable in exactly 2 steps.
+     * @brief Multiplying by this semiring runs on bit rows, 64 columns per word.
+    **/
+    template<typename W, typename D>
+    struct OrAnd {
+        static D zero() {return D(0);}
+        static D one() {return D(1);}
+        // the values are 0 or 1, so or is max and and is *, which also holds for floating point accumulators
+        template<typename T> static void multiplyAdd(T &acc, const T &x, const T &y) {
+            const T both = x * y;
+            acc = acc < both ? both : acc;
+        }
+        static D load(W w) {return w == NO_EDGE ? D(0) : D(1);}
+        static W store(D d) {return static_cast<W>(d);}
+    };
+
+    /**
+     * @struct MaxMin
+     * @brief The (max, min) semiring, the product is the widest walk of length 2 (its lightest edge is the heaviest).
+    **/
+    template<typename W, typename D>
+    struct MaxMin {
+        static D zero() {return std::numeric_limits<D>::lowest();}
+        static D one() {return std::numeric_limits<D>::max();}
+        template<typename T> static void multiplyAdd(T &acc, const T &x, const T &y) {
+            const T narrow = x < y ? x : y;
+            acc = acc < narrow ? narrow : acc;
+        }
+        static D load(W w) {return w == NO_EDGE ? zero() : static_cast<D>(w);}
+        // one is wider than W, it is stored as the widest weight
+        static W store(D d) {
+            return d == zero() ? W(NO_EDGE) : static_cast<W>(std::min<D>(d, static_cast<D>(std::numeric_limits<W>::max())));
+        }
+    };
+}
@@ -0,0 +1,123 @@
+#include <vector>
+#include <type_traits>
+#include <cstddef>
+#include "Gemm.hpp"
+#pragma once
+
+namespace GraphLib{
+
+        namespace Strassen{
+                // Blocks of at most LEAF rows are multiplied by the classic tiled product.
+                const size_t LEAF = 512;
+
+                /**
+                 * @brief Whether the Strassen-Winograd product is used for n x n matrices of weight W.
+                 * @brief Only integral weights qualify, the recursion adds and subtracts blocks in another order,
+                 * @brief which is exact modulo 2^64 for integers but would round floating point sums differently.
+                **/
+                template<typename W>
+                bool enabled(size_t n) {return std::is_integral<W>::value && n > 2 * LEAF;}
+
+                /**
+                 * @brief z = x + y for h x h blocks with their own row strides, z may be x or y.
+                **/
+                template<typename U>
+                void add(const U *x, size_t ldx, const U *y, size_t ldy, U *z, size_t ldz, size_t h){
+                        for(size_t i = 0; i < h; i++){
+                                for(size_t j = 0; j < h; j++){
+                                        z[i * ldz + j] = x[i * ldx + j] + y[i * ldy + j];
+                                }
+                        }
+                }
+
+                /**
+                 * @brief z = x - y for h x h blocks with their own row strides, z may be x or y.
+                **/
+                template<typename U>
+                void sub(const U *x, size_t ldx, const U *y, size_t ldy, U *z, size_t ldz, size_t h){
+                        for(size_t i = 0; i < h; i++){
+                                for(size_t j = 0; j < h; j++){
+                                        z[i * ldz + j] = x[i * ldx + j] - y[i * ldy + j];
+                                }
+                        }
+                }
+
+                /**
+                 * @brief c = a * b for n x n blocks of unsigned 64 bit values, n is leaf or less or an even number.
+                 * @brief The Winograd schedule computes 7 half size products with 15 block additions and keeps
+                 * @brief only two half size temporaries per level, the products are written into the quadrants of c.
+                **/
+                template<typename U>
+                void winograd(const U *a, size_t lda, const U *b, size_t ldb, U *c, size_t ldc, size_t n, size_t leaf){
+                        if(n <= leaf){
+                                Gemm::multiply<U, U, PlusTimes<U, U>>(a, lda, b, ldb, c, ldc, n);
+                                return;
+                        }
+                        size_t h = n / 2;
+                        const U *a11 = a, *a12 = a + h, *a21 = a + h * lda, *a22 = a + h * lda + h;
+                        const U *b11 = b, *b12 = b + h, *b21 = b + h * ldb, *b22 = b + h * ldb + h;
+                        U *c11 = c, *c12 = c + h, *c21 = c + h * ldc, *c22 = c + h * ldc + h;
+                        std::vector<U> tx(h * h);
+                        std::vector<U> ty(h * h);
+                        U *x = tx.data();
+                        U *y = ty.data();
+                        sub(a11, lda, a21, lda, x, h, h);                         // S3 = A11 - A21
+                        sub(b22, ldb, b12, ldb, y, h, h);                         // T3 = B22 - B12
+                        winograd(x, h, y, h, c21, ldc, h, leaf);                  // M7 = S3 * T3
+                        add(a21, lda, a22, lda, x, h, h);                         // S1 = A21 + A22
+                        sub(b12, ldb, b11, ldb, y, h, h);                         // T1 = B12 - B11
+                        winograd(x, h, y, h, c22, ldc, h, leaf);                  // M5 = S1 * T1
+                        sub(x, h, a11, lda, x, h, h);                             // S2 = S1 - A11
+                        sub(b22, ldb, y, h, y, h, h);                             // T2 = B22 - T1
+                        winograd(x, h, y, h, c12, ldc, h, leaf);                  // M6 = S2 * T2
+                        sub(a12, lda, x, h, x, h, h);                             // S4 = A12 - S2
+                        winograd(x, h, b22, ldb, c11, ldc, h, leaf);              // M3 = S4 * B22
+                        winograd(a11, lda, b11, ldb, x, h, h, leaf);              // M1 = A11 * B11
+                        add(x, h, c12, ldc, c12, ldc, h);                         // U2 = M1 + M6
+                        add(c12, ldc, c21, ldc, c21, ldc, h);                     // U3 = U2 + M7
+                        add(c12, ldc, c22, ldc, c12, ldc, h);                     // U4 = U2 + M5
+                        add(c21, ldc, c22, ldc, c22, ldc, h);                     // C22 = U7 = U3 + M5
+                        add(c12, ldc, c11, ldc, c12, ldc, h);                     // C12 = U5 = U4 + M3
+                        sub(y, h, b21, ldb, y, h, h);                             // T4 = T2 - B21
+                        winograd(a22, lda, y, h, c11, ldc, h, leaf);              // M4 = A22 * T4
+                        sub(c21, ldc, c11, ldc, c21, ldc, h);                     // C21 = U6 = U3 - M4
+                        winograd(a12, lda, b21, ldb, c11, ldc, h, leaf);          // M2 = A12 * B21
+                        add(x, h, c11, ldc, c11, ldc, h);                         // C11 = U1 = M1 + M2
+                }
+
+                /**
+                 * @brief Computes out = a * b for contiguous row-major n x n matrices of integral weights.
+                 * @brief The matrices are widened to unsigned 64 bit values and padded with NO_EDGE to m * 2^k rows
+                 * @brief with m at most leaf, so every level of the recursion splits evenly. Unsigned arithmetic wraps,
+                 * @brief so the result equals the classic product accumulated in D modulo 2^64, bit for bit after the
+                 * @brief conversion back to W.
+                 * @param leaf The size of the blocks multiplied by the classic product.
+                **/
+                template<typename W, typename D>
+                void multiply(const W *a, const W *b, W *out, size_t n, size_t leaf = LEAF){
+                        typedef uint64_t U;
+                        size_t levels = 0;
+                        size_t m = n;
+                        while(m > leaf){
+                                m = (m + 1) / 2;
+                                levels++;
+                        }
+                        size_t padded = m << levels;
+                        std::vector<U> wa(padded * padded, U(NO_EDGE));
+                        std::vector<U> wb(padded * padded, U(NO_EDGE));
+                        std::vector<U> wc(padded * padded);
+                        for(size_t i = 0; i < n; i++){
+                                for(size_t j = 0; j < n; j++){
+                                        wa[i * padded + j] = static_cast<U>(static_cast<D>(a[i * n + j]));
+                                        wb[i * padded + j] = static_cast<U>(static_cast<D>(b[i * n + j]));
+                                }
+                        }
+                        winograd(wa.data(), padded, wb.data(), padded, wc.data(), padded, padded, leaf);
+                        for(size_t i = 0; i < n; i++){
+                                for(size_t j = 0; j < n; j++){
+                                        out[i * n + j] = static_cast<W>(static_cast<D>(wc[i * padded + j]));
+                                }
+                        }
+                }
+        }
+}
@@ -1,9 +1,14 @@
 #include "doctest.h"
 #include "Algorithms.hpp"
 #include "Graph.hpp"
+#include "Strassen.hpp"
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <set>
+#include <unordered_set>
 #include <stdexcept>
+#include <thread>
 #include <iostream>
 
 TEST_CASE("Test operations on unloaded graphs")
@@ -322,3 +327,1298 @@ TEST_CASE("Test bigger than smaller than")
     CHECK_EQ(g1 > g3 && g1 >= g3 && g3 < g1 && g3 <= g1, true);
     
 }
+
+TEST_CASE("Test sparse (CSR) graphs")
+{
+    GraphLib::Graph dense;
+    GraphLib::Graph sparse;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,1,NO_EDGE,NO_EDGE},
+        {1,NO_EDGE,4,NO_EDGE},
+        {NO_EDGE,4,NO_EDGE,2},
+        {NO_EDGE,NO_EDGE,2,NO_EDGE}
+    };
+    dense.loadGraph(graph);
+
+    GraphLib::CSR csr;
+    csr.offsets = {0, 1, 3, 5, 6};
+    csr.cols = {1, 0, 2, 1, 3, 2};
+    csr.weights = {1, 1, 4, 4, 2, 2};
+    sparse.loadGraph(csr);
+
+    CHECK(sparse.isSparse());
+    CHECK_EQ(!sparse.isDirected() && sparse.isWeighted() && !sparse.isNegValues(), true);
+    CHECK(sparse.getGraph() == graph);
+    CHECK(sparse == dense);
+    CHECK_EQ(sparse.getWeight(2, 3), 2);
+    CHECK_EQ(sparse.getWeight(0, 3), NO_EDGE);
+    CHECK_EQ(sparse.countEdges(), 6);
+    CHECK(GraphLib::Algorithms::shortestPath(sparse, 0, 3) == GraphLib::Algorithms::shortestPath(dense, 0, 3));
+    CHECK(GraphLib::Algorithms::isConnected(sparse) == "The graph is connected.");
+    CHECK(GraphLib::Algorithms::isContainsCycle(sparse) == "There is no cycle in the graph.");
+
+    dense.toSparse();
+    CHECK(dense.isSparse());
+    CHECK(dense.getCSR().cols == csr.cols);
+    CHECK((sparse + dense).getGraph() == (dense * 2).getGraph());
+    sparse.toDense();
+    CHECK_EQ(!sparse.isSparse() && sparse.getGraph() == graph, true);
+
+    csr.cols[1] = 4;
+    CHECK_THROWS_AS(sparse.loadGraph(csr), std::invalid_argument);
+}
+
+TEST_CASE("Test bitset storage of unweighted graphs")
+{
+    GraphLib::Graph g1;
+    GraphLib::Graph g2;
+    std::vector<std::vector<int>> graph(70, std::vector<int>(70, NO_EDGE));
+    // a path 0-1-...-69 so rows cross the 64 bit word boundary
+    for(size_t i = 0; i + 1 < graph.size(); i++){
+        graph[i][i + 1] = 1;
+        graph[i + 1][i] = 1;
+    }
+    g1.loadGraph(graph);
+    CHECK(g1.isBitset());
+    CHECK_EQ(!g1.isDirected() && !g1.isWeighted(), true);
+    CHECK_EQ(g1.countEdges(), 138);
+    CHECK_EQ(g1.getWeight(63, 64), 1);
+    CHECK_EQ(g1.getWeight(0, 69), NO_EDGE);
+    CHECK(g1.getGraph() == graph);
+    CHECK(GraphLib::Algorithms::isConnected(g1) == "The graph is connected.");
+    CHECK(GraphLib::Algorithms::shortestPath(g1, 62, 66) == "The shortest path is: 62->63->64->65->66");
+    CHECK(GraphLib::Algorithms::isContainsCycle(g1) == "There is no cycle in the graph.");
+
+    g2 = g1 * 2;
+    CHECK_EQ(!g2.isBitset() && g2.isWeighted(), true);
+    g2 /= 2;
+    CHECK(g2.isBitset());
+    CHECK(g2 == g1);
+    g2.toDense();
+    CHECK_EQ(!g2.isBitset() && g2 == g1, true);
+}
+
+TEST_CASE("Test graphs with other weight types")
+{
+    GraphLib::BasicGraph<uint8_t> capacity;
+    std::vector<std::vector<uint8_t>> capacities {
+        {0, 200, 0},
+        {200, 0, 100},
+        {0, 100, 0}
+    };
+    capacity.loadGraph(capacities);
+    CHECK_EQ(!capacity.isNegValues() && capacity.isWeighted() && !capacity.isDirected(), true);
+    CHECK_EQ(capacity.getWeight(0, 1), 200);
+    CHECK(GraphLib::Algorithms::shortestPath(capacity, 0, 2) == "The shortest path is: 0->1->2");
+
+    // distances beyond the range of int are accumulated in 64 bits
+    GraphLib::BasicGraph<int64_t> cost;
+    int64_t big = 3000000000LL;
+    std::vector<std::vector<int64_t>> costs {
+        {0, big, 0, 1},
+        {0, 0, big, 0},
+        {0, 0, 0, 0},
+        {0, 0, 1, 0}
+    };
+    cost.loadGraph(costs);
+    CHECK(GraphLib::Algorithms::shortestPath(cost, 0, 2) == "The shortest path is: 0->3->2");
+    CHECK_EQ((cost * cost).getWeight(0, 2), big * big + 1);
+
+    GraphLib::BasicGraph<float> real;
+    std::vector<std::vector<float>> reals {
+        {0, 0.5f, 2.0f},
+        {0.5f, 0, 0.25f},
+        {2.0f, 0.25f, 0}
+    };
+    real.loadGraph(reals);
+    CHECK(GraphLib::Algorithms::shortestPath(real, 0, 2) == "The shortest path is: 0->1->2");
+    CHECK_EQ((real * 2.0f).getWeight(1, 2), 0.5f);
+}
+
+TEST_CASE("Test moving graphs")
+{
+    GraphLib::Graph a;
+    GraphLib::Graph b;
+    GraphLib::Graph c;
+    std::vector<std::vector<int>> graph1 {
+        {NO_EDGE,1,1},
+        {2,NO_EDGE,3},
+        {1,4,5}
+    };
+    std::vector<std::vector<int>> graph2 {
+        {-3,1,1},
+        {2,NO_EDGE,3},
+        {1,4,5}
+    };
+    std::vector<std::vector<int>> expected {
+        {-6,2,2},
+        {4,NO_EDGE,6},
+        {2,8,10}
+    };
+    a.loadGraph(graph1);
+    b.loadGraph(graph2);
+    c.loadGraph(graph1);
+
+    GraphLib::Graph g = a + b - c + b * 1;
+    CHECK(g.getGraph() == expected);
+    CHECK((-(a * 2) / 2).getGraph() == (-a).getGraph());
+
+    GraphLib::Graph moved(std::move(g));
+    CHECK_EQ(moved.getGraph() == expected && moved.isNegValues() && !g.isLoaded(), true);
+    g = std::move(moved);
+    CHECK_EQ(g.getGraph() == expected && !moved.isLoaded(), true);
+    CHECK_THROWS_AS(a = std::move(moved), std::invalid_argument);
+
+    std::vector<std::vector<int>> rows = graph1;
+    c.loadGraph(std::move(rows));
+    CHECK_EQ(c == a && rows.empty(), true);
+    GraphLib::Graph::Matrix flat {NO_EDGE, 1, 1, 2, NO_EDGE, 3, 1, 4, 5};
+    c.loadGraph(3, std::move(flat));
+    CHECK(c == a);
+    GraphLib::Graph::Matrix wrong(5);
+    CHECK_THROWS_AS(c.loadGraph(3, std::move(wrong)), std::invalid_argument);
+}
+
+TEST_CASE("Test lazy graph expressions")
+{
+    GraphLib::Graph g1;
+    GraphLib::Graph g2;
+    GraphLib::Graph g3;
+    GraphLib::Graph unloaded;
+    std::vector<std::vector<int>> graph1 {
+        {NO_EDGE,1,1},
+        {2,NO_EDGE,3},
+        {1,4,5}
+    };
+    std::vector<std::vector<int>> graph2 {
+        {-3,1,1},
+        {2,NO_EDGE,3},
+        {1,4,5}
+    };
+    std::vector<std::vector<int>> graph3 {
+        {1,1},
+        {1,1}
+    };
+    g1.loadGraph(graph1);
+    g2.loadGraph(graph2);
+    g3.loadGraph(graph3);
+
+    GraphLib::Graph fused = (GraphLib::lazy(g1) + g2) * 3 - g1;
+    CHECK(fused == (g1 + g2) * 3 - g1);
+    CHECK_EQ(fused.isNegValues() && fused.isWeighted() && fused.isDirected(), true);
+    fused = -GraphLib::lazy(g2) / 1 + g2;
+    CHECK_EQ(fused.countEdges() == 0 && !fused.isWeighted() && fused.isBitset(), true);
+    fused = GraphLib::lazy(g1) - g1 + fused;
+    CHECK(fused.getGraph() == std::vector<std::vector<int>>(3, std::vector<int>(3, NO_EDGE)));
+
+    CHECK_THROWS_AS(GraphLib::lazy(unloaded), std::invalid_argument);
+    CHECK_THROWS_AS(GraphLib::lazy(g1) + g3, std::invalid_argument);
+    CHECK_THROWS_AS(GraphLib::lazy(g1) / 0, std::invalid_argument);
+}
+
+TEST_CASE("Test vectorized elementwise kernels")
+{
+    // 37 vertices, so every instruction set also runs its scalar tail
+    size_t len = 37;
+    std::vector<std::vector<int>> graph1(len, std::vector<int>(len, NO_EDGE));
+    std::vector<std::vector<int>> graph2(len, std::vector<int>(len, NO_EDGE));
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            graph1[i][j] = (int)((i * 7 + j * 3) % 5) - 1;
+            graph2[i][j] = (int)((i + j) % 3);
+        }
+    }
+    GraphLib::Graph g1;
+    GraphLib::Graph g2;
+    g1.loadGraph(graph1);
+    g2.loadGraph(graph2);
+    GraphLib::Kernels::Level best = GraphLib::Kernels::getLevel();
+    std::vector<std::vector<int>> expected(len, std::vector<int>(len, NO_EDGE));
+    for(int level = GraphLib::Kernels::SCALAR; level <= best; level++){
+        GraphLib::Kernels::setLevel((GraphLib::Kernels::Level)level);
+        GraphLib::Graph sum = g1 + g2;
+        GraphLib::Graph scaled = g1 * 3 / 2;
+        for(size_t i = 0; i < len; i++){
+            for(size_t j = 0; j < len; j++){
+                expected[i][j] = graph1[i][j] + graph2[i][j];
+            }
+        }
+        CHECK(sum.getGraph() == expected);
+        CHECK_EQ(sum.isNegValues() && sum.isWeighted() && sum.isDirected(), true);
+        for(size_t i = 0; i < len; i++){
+            for(size_t j = 0; j < len; j++){
+                expected[i][j] = graph1[i][j] * 3 / 2;
+            }
+        }
+        CHECK(scaled.getGraph() == expected);
+        // the symmetric operand stays symmetric without being checked again
+        GraphLib::Graph shifted = g2 - g2 - g2;
+        ++shifted;
+        CHECK_EQ(!shifted.isDirected() && shifted.isNegValues(), true);
+        ++shifted;
+        CHECK_EQ(!shifted.isDirected() && !shifted.isNegValues() && shifted.isWeighted(), true);
+    }
+    GraphLib::Kernels::setLevel(best);
+    CHECK_EQ(GraphLib::Kernels::getLevel(), best);
+}
+
+TEST_CASE("Test blocked matrix product")
+{
+    // 150 vertices, so the product runs several panels and partial register blocks
+    size_t len = 150;
+    std::vector<std::vector<int>> graph1(len, std::vector<int>(len, NO_EDGE));
+    std::vector<std::vector<int>> graph2(len, std::vector<int>(len, NO_EDGE));
+    std::vector<std::vector<double>> real(len, std::vector<double>(len, NO_EDGE));
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            graph1[i][j] = (int)((i * 31 + j * 17) % 11) - 5;
+            graph2[i][j] = (i + j) % 4 == 0 ? 1 : NO_EDGE;
+            real[i][j] = (double)((i * 3 + j) % 5) / 2;
+        }
+    }
+    GraphLib::Graph g1;
+    GraphLib::Graph g2;
+    GraphLib::BasicGraph<double> g3;
+    g1.loadGraph(graph1);
+    g2.loadGraph(graph2);
+    g3.loadGraph(real);
+    CHECK(g2.isBitset());
+    std::vector<std::vector<int>> expected(len, std::vector<int>(len, NO_EDGE));
+    std::vector<std::vector<double>> expectedReal(len, std::vector<double>(len, NO_EDGE));
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            for(size_t k = 0; k < len; k++){
+                expected[i][j] += graph1[i][k] * graph2[k][j];
+                expectedReal[i][j] += real[i][k] * real[k][j];
+            }
+        }
+    }
+    CHECK((g1 * g2).getGraph() == expected);
+    // every product of halves is exact in double
+    CHECK((g3 * g3).getGraph() == expectedReal);
+}
+
+TEST_CASE("Test Strassen-Winograd product")
+{
+    // small leaves, so 150 vertices recurse 3 levels with padding, the sums wrap around int
+    size_t len = 150;
+    GraphLib::Graph::Matrix a(len * len);
+    GraphLib::Graph::Matrix b(len * len);
+    for(size_t k = 0; k < len * len; k++){
+        a[k] = (int)((k * 2654435761u) % 2001) * 1000000 - 1000000000;
+        b[k] = (int)((k * 40503u) % 7) - 3;
+    }
+    GraphLib::Graph::Matrix classic(len * len);
+    GraphLib::Graph::Matrix strassen(len * len);
+    GraphLib::Gemm::multiply<int, int64_t>(a.data(), b.data(), classic.data(), len);
+    GraphLib::Strassen::multiply<int, int64_t>(a.data(), b.data(), strassen.data(), len, 20);
+    CHECK(classic == strassen);
+    CHECK_EQ(GraphLib::Strassen::enabled<int>(4 * GraphLib::Strassen::LEAF), true);
+    CHECK_EQ(GraphLib::Strassen::enabled<double>(4 * GraphLib::Strassen::LEAF), false);
+    CHECK_EQ(GraphLib::Strassen::enabled<int>(GraphLib::Strassen::LEAF), false);
+}
+
+TEST_CASE("Test semiring products")
+{
+    GraphLib::Graph g;
+    GraphLib::Graph unloaded;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,2,5},
+        {NO_EDGE,NO_EDGE,1},
+        {3,NO_EDGE,NO_EDGE}
+    };
+    g.loadGraph(graph);
+    std::vector<std::vector<int>> lightest {
+        {8,NO_EDGE,3},
+        {4,NO_EDGE,NO_EDGE},
+        {NO_EDGE,5,8}
+    };
+    std::vector<std::vector<int>> widest {
+        {3,NO_EDGE,1},
+        {1,NO_EDGE,NO_EDGE},
+        {NO_EDGE,2,3}
+    };
+    std::vector<std::vector<int>> reachable {
+        {1,NO_EDGE,1},
+        {1,NO_EDGE,NO_EDGE},
+        {NO_EDGE,1,1}
+    };
+    CHECK(GraphLib::multiply<GraphLib::MinPlus>(g, g).getGraph() == lightest);
+    CHECK(GraphLib::multiply<GraphLib::MaxMin>(g, g).getGraph() == widest);
+    GraphLib::Graph steps = GraphLib::multiply<GraphLib::OrAnd>(g, g);
+    CHECK(steps.getGraph() == reachable);
+    CHECK_EQ(steps.isBitset() && steps.isDirected() && !steps.isWeighted(), true);
+    CHECK(GraphLib::multiply<GraphLib::PlusTimes>(g, g) == g * g);
+    CHECK_THROWS_AS(GraphLib::multiply<GraphLib::MinPlus>(g, unloaded), std::invalid_argument);
+
+    // larger than a register block and a bit word, against the definition
+    size_t len = 130;
+    std::vector<std::vector<int>> big(len, std::vector<int>(len, NO_EDGE));
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            if((i * 7 + j * 13) % 5 == 0){
+                big[i][j] = (int)((i + j) % 9) - 2;
+            }
+        }
+    }
+    GraphLib::Graph h;
+    h.loadGraph(big);
+    std::vector<std::vector<int>> expected(len, std::vector<int>(len, NO_EDGE));
+    std::vector<std::vector<int>> expectedReach(len, std::vector<int>(len, NO_EDGE));
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            bool found = false;
+            for(size_t k = 0; k < len; k++){
+                if(big[i][k] != NO_EDGE && big[k][j] != NO_EDGE){
+                    int sum = big[i][k] + big[k][j];
+                    expected[i][j] = !found || sum < expected[i][j] ? sum : expected[i][j];
+                    found = true;
+                    expectedReach[i][j] = 1;
+                }
+            }
+        }
+    }
+    CHECK(GraphLib::multiply<GraphLib::MinPlus>(h, h).getGraph() == expected);
+    CHECK(GraphLib::multiply<GraphLib::OrAnd>(h, h).getGraph() == expectedReach);
+}
+
+TEST_CASE("Test graph powers")
+{
+    GraphLib::Graph triangle;
+    GraphLib::Graph cycle;
+    GraphLib::Graph unloaded;
+    std::vector<std::vector<int>> complete {
+        {NO_EDGE,1,1},
+        {1,NO_EDGE,1},
+        {1,1,NO_EDGE}
+    };
+    std::vector<std::vector<int>> directed {
+        {NO_EDGE,2,NO_EDGE},
+        {NO_EDGE,NO_EDGE,3},
+        {4,NO_EDGE,NO_EDGE}
+    };
+    triangle.loadGraph(complete);
+    cycle.loadGraph(directed);
+
+    // walks of length k in a triangle: (2^k + 2(-1)^k) / 3 closed ones, (2^k - (-1)^k) / 3 between two vertices
+    GraphLib::Graph walks = triangle;
+    for(int k = 1; k < 10; k++){
+        walks *= triangle;
+    }
+    CHECK(triangle.power(10) == walks);
+    CHECK_EQ(triangle.power(10).getWeight(0, 1), 341);
+    CHECK(triangle.power(1) == triangle);
+    std::vector<std::vector<int>> identity {
+        {1,NO_EDGE,NO_EDGE},
+        {NO_EDGE,1,NO_EDGE},
+        {NO_EDGE,NO_EDGE,1}
+    };
+    CHECK(triangle.power(0).getGraph() == identity);
+
+    // 2^40 / 3 walks do not fit an int
+    GraphLib::BasicGraph<int64_t> wide = triangle.widePower(40);
+    CHECK_EQ(wide.getWeight(0, 1), 366503875925LL);
+    CHECK_EQ(wide.getWeight(2, 2), 366503875926LL);
+    GraphLib::Graph reduced = triangle.power(40, 1000000007);
+    CHECK_EQ(reduced.getWeight(0, 1), 503873363);
+    CHECK_EQ(reduced.getWeight(2, 2), 503873364);
+    CHECK_THROWS_AS(triangle.power(2, 0), std::invalid_argument);
+    // the residues are stored as W, a modulus with residues that do not fit W is rejected
+    CHECK_THROWS_AS(triangle.power(2, 4000000000LL), std::invalid_argument);
+    CHECK_EQ(triangle.power(40, 2147483648LL).getWeight(0, 1), 366503875925LL % 2147483648LL);
+    GraphLib::BasicGraph<int8_t> small;
+    small.loadGraph(std::vector<std::vector<int8_t>>{{0, 1, 1}, {1, 0, 1}, {1, 1, 0}});
+    CHECK_THROWS_AS(small.power(2, 1000), std::invalid_argument);
+    CHECK_EQ(small.power(10, 128).getWeight(0, 1), 341 % 128);
+    CHECK_THROWS_AS(unloaded.power(2), std::invalid_argument);
+
+    // every closed walk of 3 edges goes around the cycle once
+    std::vector<std::vector<int>> around {
+        {9,NO_EDGE,NO_EDGE},
+        {NO_EDGE,9,NO_EDGE},
+        {NO_EDGE,NO_EDGE,9}
+    };
+    CHECK(cycle.power<GraphLib::MinPlus>(3).getGraph() == around);
+    CHECK(cycle.power<GraphLib::MaxMin>(3).getGraph() == std::vector<std::vector<int>>{{2,0,0},{0,2,0},{0,0,2}});
+    GraphLib::Graph twoSteps = cycle.power<GraphLib::OrAnd>(2);
+    CHECK(twoSteps.getGraph() == std::vector<std::vector<int>>{{0,0,1},{1,0,0},{0,1,0}});
+    CHECK(cycle.power<GraphLib::OrAnd>(0).getGraph() == identity);
+}
+
+TEST_CASE("Test subgraph matching")
+{
+    GraphLib::Graph g;
+    GraphLib::Graph block;
+    GraphLib::Graph missing;
+    size_t len = 60;
+    size_t size = 8;
+    std::vector<std::vector<int>> text(len, std::vector<int>(len));
+    for(size_t i = 0; i < len; i++){
+        for(size_t j = 0; j < len; j++){
+            text[i][j] = (int)((i * 7919 + j * 104729 + i * j) % 4);
+        }
+    }
+    g.loadGraph(text);
+    // any block, not only the ones on the diagonal
+    std::vector<std::vector<int>> pattern(size, std::vector<int>(size));
+    for(size_t k = 0; k < size; k++){
+        for(size_t l = 0; l < size; l++){
+            pattern[k][l] = text[17 + k][31 + l];
+        }
+    }
+    block.loadGraph(pattern);
+    CHECK_EQ(block.subGraph(g), true);
+    CHECK_EQ(g.subGraph(g), true);
+    CHECK_EQ(g.subGraph(block), false);
+    pattern[3][4] = 9;
+    missing.loadGraph(pattern);
+    CHECK_EQ(missing.subGraph(g), false);
+
+    // a block that is not there is not a subgraph
+    GraphLib::Graph full;
+    GraphLib::Graph heavy;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,1,1},
+        {2,NO_EDGE,3},
+        {1,4,5}
+    };
+    std::vector<std::vector<int>> heavyGraph {
+        {7,7},
+        {7,7}
+    };
+    full.loadGraph(graph);
+    heavy.loadGraph(heavyGraph);
+    CHECK_EQ(heavy.subGraph(full), false);
+
+    // unweighted and sparse graphs are matched as their matrices
+    GraphLib::Graph bits;
+    GraphLib::Graph edges;
+    std::vector<std::vector<int>> unweighted {
+        {NO_EDGE,1,NO_EDGE},
+        {NO_EDGE,NO_EDGE,1},
+        {1,NO_EDGE,NO_EDGE}
+    };
+    std::vector<std::vector<int>> corner {
+        {1,NO_EDGE},
+        {NO_EDGE,1}
+    };
+    bits.loadGraph(unweighted);
+    edges.loadGraph(corner);
+    CHECK(bits.isBitset());
+    CHECK_EQ(edges.subGraph(bits), true);
+    bits.toSparse();
+    CHECK_EQ(edges.subGraph(bits), true);
+    CHECK_THROWS_AS(edges.subGraph(GraphLib::Graph()), std::invalid_argument);
+}
+
+TEST_CASE("Test graph ordering")
+{
+    GraphLib::Graph g1;
+    GraphLib::Graph g2;
+    std::vector<std::vector<int>> graph1 {
+        {NO_EDGE,1,2},
+        {NO_EDGE,NO_EDGE,NO_EDGE},
+        {NO_EDGE,NO_EDGE,NO_EDGE}
+    };
+    std::vector<std::vector<int>> graph2 {
+        {NO_EDGE,NO_EDGE,NO_EDGE},
+        {NO_EDGE,NO_EDGE,NO_EDGE},
+        {2,1,NO_EDGE}
+    };
+    g1.loadGraph(graph1);
+    g2.loadGraph(graph2);
+    // equal graphs are not less than each other
+    GraphLib::Graph copy = g1;
+    CHECK_EQ(!(g1 < copy) && !(copy < g1) && g1 <= copy && g1 >= copy, true);
+    // same edges and vertices, exactly one of them is less
+    CHECK_EQ((g1 < g2) != (g2 < g1), true);
+    CHECK_EQ((g1 < g2) == (g2 > g1) && (g1 <= g2) == !(g1 > g2), true);
+
+    // the cached key follows the changes of the graph
+    GraphLib::Graph bigger = g1;
+    CHECK_EQ(bigger <= g1, true);
+    bigger += g2;
+    CHECK_EQ(g1 < bigger && g2 < bigger, true);
+    bigger *= 0;
+    CHECK_EQ(bigger < g1, true);
+
+    // sorting and deduplicating graphs
+    std::vector<GraphLib::Graph> graphs;
+    for(int k = 0; k < 200; k++){
+        std::vector<std::vector<int>> mat(3 + (size_t)(k % 3), std::vector<int>(3 + (size_t)(k % 3), NO_EDGE));
+        mat[(size_t)(k % 3)][(size_t)(k % 2)] = 1 + k % 5;
+        mat[2][(size_t)(k % 3)] = k % 4;
+        GraphLib::Graph g;
+        g.loadGraph(mat);
+        graphs.push_back(g);
+    }
+    std::sort(graphs.begin(), graphs.end());
+    for(size_t k = 1; k < graphs.size(); k++){
+        CHECK_EQ(graphs[k - 1] <= graphs[k], true);
+        CHECK_EQ(graphs[k - 1].countEdges() <= graphs[k].countEdges(), true);
+    }
+    std::set<GraphLib::Graph> unique(graphs.begin(), graphs.end());
+    size_t distinct = 1;
+    for(size_t k = 1; k < graphs.size(); k++){
+        if(graphs[k - 1] != graphs[k]){
+            distinct++;
+        }
+    }
+    CHECK_EQ(unique.size(), distinct);
+}
+
+TEST_CASE("Test graph hashing")
+{
+    GraphLib::Graph dense;
+    GraphLib::Graph sparse;
+    GraphLib::Graph other;
+    GraphLib::Graph unloaded;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,3,NO_EDGE},
+        {3,NO_EDGE,-1},
+        {NO_EDGE,-1,NO_EDGE}
+    };
+    dense.loadGraph(graph);
+    sparse.loadGraph(graph);
+    sparse.toSparse();
+    // the fingerprint does not depend on the storage
+    CHECK_EQ(dense.hash(), sparse.hash());
+    CHECK(dense == sparse);
+    graph[0][1] = 4;
+    other.loadGraph(graph);
+    CHECK_NE(dense.hash(), other.hash());
+    CHECK(dense != other);
+    // the fingerprint follows the changes of the graph
+    other -= dense;
+    other += dense;
+    CHECK_NE(dense.hash(), other.hash());
+    GraphLib::Graph before = other;
+    other *= 2;
+    CHECK(other != before);
+    other /= 2;
+    CHECK_EQ(other.hash(), before.hash());
+    CHECK(other == before);
+    // graphs without edges of different sizes
+    GraphLib::Graph empty2;
+    GraphLib::Graph empty3;
+    empty2.loadGraph(std::vector<std::vector<int>>(2, std::vector<int>(2, NO_EDGE)));
+    empty3.loadGraph(std::vector<std::vector<int>>(3, std::vector<int>(3, NO_EDGE)));
+    CHECK_NE(empty2.hash(), empty3.hash());
+    CHECK_THROWS_AS(unloaded.hash(), std::invalid_argument);
+
+    // deduplicating graphs in an unordered container
+    std::unordered_set<GraphLib::Graph> unique;
+    for(int k = 0; k < 100; k++){
+        std::vector<std::vector<int>> mat(4, std::vector<int>(4, NO_EDGE));
+        mat[(size_t)(k % 4)][(size_t)(k % 3)] = 1 + k % 5;
+        GraphLib::Graph g;
+        g.loadGraph(mat);
+        unique.insert(g);
+    }
+    CHECK_EQ(unique.size(), 60);
+    CHECK_EQ(std::hash<GraphLib::Graph>()(dense), (size_t)dense.hash());
+}
+
+TEST_CASE("Test flag counters")
+{
+    GraphLib::Graph g;
+    std::vector<std::vector<int>> graph(100, std::vector<int>(100, NO_EDGE));
+    for(size_t i = 0; i < 100; i++){
+        for(size_t j = 0; j < 100; j++){
+            graph[i][j] = (int)((i * j) % 3);
+        }
+    }
+    g.loadGraph(graph);
+    CHECK_EQ(!g.isDirected() && g.isWeighted() && !g.isNegValues(), true);
+    CHECK_EQ(g.countEdges(), 4356);
+    // one asymmetric pair far from the diagonal tiles, and one negative entry
+    graph[3][97] = -4;
+    g.loadGraph(graph);
+    CHECK_EQ(g.isDirected() && g.isWeighted() && g.isNegValues(), true);
+    CHECK_EQ(g.countEdges(), 4357);
+    // the counts do not depend on the storage
+    GraphLib::Graph sparse;
+    sparse.loadGraph(graph);
+    sparse.toSparse();
+    sparse.updateGraphFlags();
+    CHECK_EQ(sparse.isDirected() && sparse.isWeighted() && sparse.isNegValues(), true);
+    std::vector<std::vector<int>> mirrored {
+        {NO_EDGE,1,NO_EDGE},
+        {1,NO_EDGE,NO_EDGE},
+        {1,NO_EDGE,1}
+    };
+    GraphLib::Graph bits;
+    bits.loadGraph(mirrored);
+    CHECK_EQ(bits.isBitset() && bits.isDirected() && !bits.isWeighted(), true);
+    CHECK_EQ(bits.countEdges(), 4);
+    mirrored[0][2] = 1;
+    bits.loadGraph(mirrored);
+    CHECK_EQ(bits.isDirected(), false);
+    bits.toSparse();
+    bits.updateGraphFlags();
+    CHECK_EQ(bits.isDirected(), false);
+    // the edge count follows the operators
+    bits += bits;
+    CHECK_EQ(bits.countEdges(), 5);
+    bits -= bits;
+    CHECK_EQ(bits.countEdges(), 0);
+}
+
+TEST_CASE("Test edge updates")
+{
+    GraphLib::Graph g;
+    GraphLib::Graph unloaded;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,1,NO_EDGE},
+        {1,NO_EDGE,1},
+        {NO_EDGE,1,NO_EDGE}
+    };
+    g.loadGraph(graph);
+    CHECK_EQ(g.isBitset() && !g.isDirected() && g.countEdges() == 4, true);
+    // a bitset graph stays a bitset while its weights are 1
+    g.setEdge(0, 2, 1);
+    CHECK_EQ(g.isBitset() && g.isDirected() && g.countEdges() == 5, true);
+    g.setEdge(2, 0, 1);
+    CHECK_EQ(g.isDirected(), false);
+    uint64_t before = g.hash();
+    g.setEdge(1, 1, 5);
+    CHECK_EQ(!g.isBitset() && g.isWeighted() && !g.isNegValues() && !g.isDirected(), true);
+    g.setEdge(0, 1, -2);
+    CHECK_EQ(g.isNegValues() && g.isDirected(), true);
+    g.removeEdge(0, 1);
+    g.setEdge(0, 1, 1);
+    g.removeEdge(1, 1);
+    CHECK_EQ(!g.isWeighted() && !g.isNegValues() && !g.isDirected(), true);
+    // the incremental fingerprint and count equal the ones of the same graph loaded from scratch
+    CHECK_EQ(g.hash(), before);
+    GraphLib::Graph loaded;
+    graph[0][2] = 1;
+    graph[2][0] = 1;
+    loaded.loadGraph(graph);
+    CHECK(g == loaded);
+    CHECK_EQ(g.countEdges(), loaded.countEdges());
+
+    // sparse graphs insert and remove in their rows
+    GraphLib::Graph sparse;
+    sparse.loadGraph(graph);
+    sparse.toSparse();
+    sparse.setEdges({{2, 2, 7}, {0, 0, 3}, {1, 0, NO_EDGE}});
+    CHECK_EQ(sparse.isSparse() && sparse.isWeighted() && sparse.isDirected(), true);
+    CHECK(sparse.getGraph() == std::vector<std::vector<int>>{{3,1,1},{0,0,1},{1,1,7}});
+    sparse.removeEdges({{0, 0}, {2, 2}, {0, 0}});
+    sparse.setEdge(1, 0, 1);
+    CHECK_EQ(sparse.isSparse() && !sparse.isWeighted() && !sparse.isDirected(), true);
+    CHECK(sparse == loaded);
+    CHECK_EQ(sparse.hash(), loaded.hash());
+
+    // new vertices have no edges
+    CHECK_EQ(sparse.addVertex(), 3);
+    CHECK_EQ(loaded.addVertices(70), 3);
+    CHECK_EQ(loaded.isBitset() && loaded.getNumVertices() == 73 && loaded.countEdges() == 6, true);
+    loaded.setEdge(72, 3, 1);
+    CHECK_EQ(loaded.getWeight(72, 3) == 1 && loaded.getWeight(0, 1) == 1 && loaded.getWeight(1, 72) == NO_EDGE, true);
+    GraphLib::Graph dense;
+    dense.loadGraph(std::vector<std::vector<int>>{{2,NO_EDGE},{NO_EDGE,3}});
+    CHECK_EQ(dense.addVertices(2), 2);
+    CHECK(dense.getGraph() == std::vector<std::vector<int>>{{2,0,0,0},{0,3,0,0},{0,0,0,0},{0,0,0,0}});
+    dense.setEdge(3, 1, 4);
+    CHECK_EQ(dense.isDirected() && dense.countEdges() == 3, true);
+
+    // either every update is applied or none
+    CHECK_THROWS_AS(dense.setEdges({{0, 1, 2}, {0, 4, 2}}), std::invalid_argument);
+    CHECK_EQ(dense.getWeight(0, 1), NO_EDGE);
+    CHECK_THROWS_AS(dense.setEdge(4, 0, 1), std::invalid_argument);
+    CHECK_THROWS_AS(unloaded.setEdge(0, 0, 1), std::invalid_argument);
+    CHECK_THROWS_AS(unloaded.addVertex(), std::invalid_argument);
+}
+
+TEST_CASE("Test batched edge updates")
+{
+    size_t len = 90;
+    std::vector<GraphLib::Graph::EdgeUpdate> updates;
+    for(size_t k = 0; k < 3000; k++){
+        size_t from = (k * 7919) % len;
+        size_t to = (k * 104729 + k / 3) % len;
+        // repeated cells, removals and weights of 1 only at first
+        int weight = k < 1000 ? (int)(k % 2) : (int)(k % 5) - 1;
+        updates.push_back(GraphLib::Graph::EdgeUpdate{from, to, weight});
+    }
+    std::vector<std::vector<int>> graph(len, std::vector<int>(len, NO_EDGE));
+    for(size_t i = 0; i < len; i++){
+        graph[i][(i * 3) % len] = 1;
+    }
+    for(int mode = 0; mode < 3; mode++){
+        GraphLib::Graph batch;
+        GraphLib::Graph single;
+        batch.loadGraph(graph);
+        single.loadGraph(graph);
+        if(mode == 1){
+            batch.toSparse();
+        }
+        if(mode == 2){
+            graph[0][0] = 5;
+            batch.loadGraph(graph);
+            single.loadGraph(graph);
+        }
+        batch.hash();
+        for(size_t count = 0; count < updates.size(); count += 1000){
+            batch.applyUpdates(updates.data() + count, 1000);
+            for(size_t k = count; k < count + 1000; k++){
+                single.setEdge(updates[k].from, updates[k].to, updates[k].weight);
+            }
+            CHECK(batch == single);
+            CHECK_EQ(batch.hash(), single.hash());
+            CHECK_EQ(batch.countEdges(), single.countEdges());
+            CHECK_EQ(batch.isDirected() == single.isDirected() && batch.isWeighted() == single.isWeighted()
+                     && batch.isNegValues() == single.isNegValues(), true);
+            GraphLib::Graph loaded;
+            loaded.loadGraph(single.getGraph());
+            CHECK_EQ(batch.isDirected() == loaded.isDirected() && batch.isWeighted() == loaded.isWeighted()
+                     && batch.isNegValues() == loaded.isNegValues() && batch.hash() == loaded.hash(), true);
+        }
+        CHECK_EQ(batch.isSparse(), mode == 1);
+    }
+    GraphLib::Graph g;
+    g.loadGraph(graph);
+    std::vector<GraphLib::Graph::EdgeUpdate> invalid {{0, 1, 2}, {len, 0, 1}};
+    CHECK_THROWS_AS(g.applyUpdates(invalid.data(), invalid.size()), std::invalid_argument);
+    CHECK_EQ(g.getWeight(0, 1), NO_EDGE);
+}
+
+TEST_CASE("Test copy on write storage")
+{
+    std::vector<std::vector<int>> weighted {
+        {NO_EDGE,2,NO_EDGE},
+        {2,NO_EDGE,3},
+        {NO_EDGE,3,NO_EDGE}
+    };
+    std::vector<std::vector<int>> unweighted {
+        {NO_EDGE,1,NO_EDGE},
+        {1,NO_EDGE,1},
+        {NO_EDGE,1,NO_EDGE}
+    };
+    for(int mode = 0; mode < 3; mode++){
+        GraphLib::Graph original;
+        original.loadGraph(mode == 2 ? unweighted : weighted);
+        if(mode == 1){
+            original.toSparse();
+        }
+        std::vector<std::vector<int>> before = original.getGraph();
+        // every copy shares the storage until it changes, the other copies keep their values
+        GraphLib::Graph copy = original;
+        GraphLib::Graph assigned;
+        assigned = original;
+        GraphLib::Graph positive = +original;
+        copy.setEdge(0, 2, 1);
+        assigned += original;
+        positive++;
+        GraphLib::Graph negative = -original;
+        GraphLib::Graph grown = original;
+        grown.addVertex();
+        CHECK(original.getGraph() == before);
+        CHECK_EQ(copy.getWeight(0, 2), 1);
+        CHECK_EQ(assigned.getWeight(0, 1), 2 * before[0][1]);
+        CHECK_EQ(positive.getWeight(0, 0), 1);
+        CHECK_EQ(negative.getWeight(0, 1), -before[0][1]);
+        CHECK_EQ(grown.getNumVertices(), 4);
+        // an operand that shares the storage of the graph it is added to
+        GraphLib::Graph twice = original;
+        twice += twice;
+        CHECK_EQ(twice.getWeight(1, 2), 2 * before[1][2]);
+        CHECK(original.getGraph() == before);
+        CHECK_EQ(original.countEdges(), 4);
+    }
+}
+
+TEST_CASE("Test row views")
+{
+    GraphLib::Graph dense;
+    GraphLib::Graph bits;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,1,NO_EDGE,NO_EDGE,NO_EDGE},
+        {NO_EDGE,NO_EDGE,-3,NO_EDGE,NO_EDGE},
+        {NO_EDGE,1,NO_EDGE,4,NO_EDGE},
+        {NO_EDGE,NO_EDGE,NO_EDGE,NO_EDGE,2},
+        {NO_EDGE,NO_EDGE,NO_EDGE,NO_EDGE,NO_EDGE}
+    };
+    dense.loadGraph(graph);
+    GraphLib::RowSpan<int> row = dense.getRow(2);
+    CHECK_EQ(row.size() == 5 && row[3] == 4 && row.data() == dense.getRow(2).data(), true);
+    CHECK(std::vector<int>(row.begin(), row.end()) == graph[2]);
+    CHECK_EQ(dense.weightAt(1, 2), -3);
+    bits.loadGraph(std::vector<std::vector<int>>{{NO_EDGE,1},{1,NO_EDGE}});
+    CHECK_EQ(bits.getRow(0).empty() && bits.weightAt(0, 1) == 1, true);
+    CHECK_THROWS_AS(dense.getRow(5), std::invalid_argument);
+
+    // the algorithms read the graph in place and leave it unchanged
+    std::vector<std::vector<int>> before = dense.getGraph();
+    CHECK(GraphLib::Algorithms::negativeCycle(dense) == "The negative cycle is: 1->2->1");
+    CHECK(GraphLib::Algorithms::shortestPath(dense, 0, 4) == "0 and 4 are connected by a negative weight cycle.");
+    CHECK(GraphLib::Algorithms::shortestPath(dense, 3, 4) == "The shortest path is: 3->4");
+    CHECK(dense.getGraph() == before);
+    dense.toSparse();
+    CHECK(GraphLib::Algorithms::negativeCycle(dense) == "The negative cycle is: 1->2->1");
+    GraphLib::Graph directed;
+    directed.loadGraph(std::vector<std::vector<int>>{{0,3,0,0},{0,0,2,0},{0,0,0,5},{7,0,0,0}});
+    CHECK(GraphLib::Algorithms::isBipartite(directed) == "The graph is bipartite: A={0, 2}, B={1, 3}.");
+    CHECK(directed.isDirected());
+    directed.toSparse();
+    CHECK(GraphLib::Algorithms::isBipartite(directed) == "The graph is bipartite: A={0, 2}, B={1, 3}.");
+    directed.setEdge(0, 2, 1);
+    CHECK(GraphLib::Algorithms::isBipartite(directed) == "The graph is not bipartite.");
+}
+
+TEST_CASE("Test packed storage")
+{
+    GraphLib::Graph g;
+    std::vector<std::vector<int>> graph {
+        {NO_EDGE,2,NO_EDGE,4},
+        {2,5,3,NO_EDGE},
+        {NO_EDGE,3,NO_EDGE,6},
+        {4,NO_EDGE,6,NO_EDGE}
+    };
+    g.loadGraph(graph);
+    CHECK_EQ(g.isPacked() && !g.isDirected() && g.isWeighted() && g.countEdges() == 9, true);
+    CHECK_EQ(g.getWeight(3, 0) == 4 && g.getWeight(0, 3) == 4 && g.getWeight(1, 1) == 5, true);
+    CHECK(g.getGraph() == graph);
+    CHECK(g.getRow(1).empty());
+    std::vector<size_t> to;
+    std::vector<int> weights;
+    for(const GraphLib::Graph::Edge &e : g.neighbours(2)){
+        to.push_back(e.to);
+        weights.push_back(e.weight);
+    }
+    CHECK_EQ(to == std::vector<size_t>({1, 3}) && weights == std::vector<int>({3, 6}), true);
+
+    // elementwise operators on packed graphs stay packed and match the dense results
+    GraphLib::Graph dense(g);
+    dense.toDense();
+    CHECK_EQ(!dense.isPacked() && dense == g && dense.hash() == g.hash(), true);
+    GraphLib::Graph sum = g + g;
+    CHECK_EQ(sum.isPacked() && sum == g * 2 && sum.getWeight(2, 3) == 12, true);
+    CHECK((g - dense).countEdges() == 0);
+    GraphLib::Graph scaled(g);
+    scaled *= -3;
+    CHECK_EQ(scaled.isPacked() && scaled.isNegValues() && scaled.getWeight(3, 2) == -18, true);
+    scaled /= -3;
+    CHECK(scaled == g);
+    ++scaled;
+    CHECK_EQ(scaled.isPacked() && scaled.getWeight(0, 2) == 1 && scaled.getWeight(2, 0) == 1, true);
+    GraphLib::Graph halved = (g + g) / 4;
+    CHECK_EQ(halved.getWeight(0, 1) == 1 && halved.getWeight(1, 0) == 1 && halved.getWeight(0, 3) == 2, true);
+
+    // a change on the diagonal keeps the symmetry, any other change breaks it and the graph switches to a dense matrix
+    GraphLib::Graph edited(g);
+    edited.setEdge(2, 2, 7);
+    CHECK_EQ(edited.isPacked() && edited.getWeight(2, 2) == 7 && edited.countEdges() == 10 && g.getWeight(2, 2) == NO_EDGE, true);
+    edited.setEdge(0, 2, 9);
+    CHECK_EQ(!edited.isPacked() && edited.isDirected() && edited.getWeight(0, 2) == 9 && edited.getWeight(2, 0) == NO_EDGE, true);
+    edited.setEdge(2, 0, 9);
+    CHECK_EQ(!edited.isDirected() && edited.countEdges() == 12, true);
+    GraphLib::Graph grown(g);
+    CHECK_EQ(grown.addVertices(2) == 4 && grown.isPacked() && grown.getNumVertices() == 6, true);
+    CHECK_EQ(grown.getWeight(3, 2) == 6 && grown.getWeight(1, 1) == 5 && grown.getWeight(5, 3) == NO_EDGE, true);
+    CHECK_EQ(grown.countEdges() == 9 && !grown.isDirected(), true);
+    CHECK(GraphLib::Algorithms::shortestPath(g, 0, 2) == GraphLib::Algorithms::shortestPath(dense, 0, 2));
+
+    // a cleared directed flag on an asymmetric matrix does not pack it, the lower triangle is kept
+    GraphLib::Graph lopsided;
+    lopsided.loadGraph(std::vector<std::vector<int>>{{0, 2, 0}, {5, 0, 3}, {0, 3, 0}});
+    lopsided.setUnDirected();
+    lopsided *= 1;
+    CHECK_EQ(!lopsided.isPacked() && lopsided.getWeight(0, 1) == 2 && lopsided.getWeight(1, 0) == 5, true);
+    lopsided.setUnDirected();
+    GraphLib::Graph doubled = lopsided + lopsided;
+    CHECK_EQ(!doubled.isPacked() && doubled.getWeight(0, 1) == 4 && doubled.getWeight(1, 0) == 10, true);
+}
+
+TEST_CASE("Test direction optimizing BFS")
+{
+    // a hub joined to most of the vertices makes the second level large enough for bottom-up steps,
+    // every later vertex has two parents on that level and the one queued first, the smaller one, is kept
+    size_t n = 200;
+    GraphLib::Graph::Matrix mat(n * n, NO_EDGE);
+    auto join = [&](size_t u, size_t v){mat[u * n + v] = 1; mat[v * n + u] = 1;};
+    for(size_t v = 1; v <= 150; v++){
+        join(0, v);
+    }
+    for(size_t v = 151; v < n; v++){
+        join(v, v - 100);
+        join(v, v - 140);
+    }
+    GraphLib::Graph g;
+    g.loadGraph(n, GraphLib::Graph::Matrix(mat));
+    CHECK_EQ(g.isBitset() && !g.isDirected(), true);
+    CHECK(GraphLib::Algorithms::shortestPath(g, 0, 160) == "The shortest path is: 0->20->160");
+    CHECK(GraphLib::Algorithms::shortestPath(g, 199, 151) == "The shortest path is: 199->59->0->11->151");
+    CHECK(GraphLib::Algorithms::isConnected(g) == "The graph is connected.");
+    GraphLib::Graph sparse(g);
+    sparse.toSparse();
+    CHECK(GraphLib::Algorithms::shortestPath(sparse, 0, 160) == "The shortest path is: 0->20->160");
+    CHECK(GraphLib::Algorithms::shortestPath(sparse, 199, 151) == "The shortest path is: 199->59->0->11->151");
+
+    // the directed graph only runs top-down steps and finds the same parents
+    mat[160 * n + 20] = NO_EDGE;
+    GraphLib::Graph directed;
+    directed.loadGraph(n, std::move(mat));
+    CHECK(directed.isDirected());
+    CHECK(GraphLib::Algorithms::shortestPath(directed, 0, 160) == "The shortest path is: 0->20->160");
+    directed.removeEdges({{0, 150}, {150, 0}});
+    CHECK(GraphLib::Algorithms::isConnected(directed) == "The graph is not connected.");
+
+    // a cleared directed flag does not make the edges two way, 21 points to the large level but is not reached
+    GraphLib::Graph oneWay;
+    std::vector<std::vector<int>> star(22, std::vector<int>(22, NO_EDGE));
+    for(size_t v = 1; v <= 20; v++){
+        star[0][v] = 1;
+    }
+    star[21][5] = 1;
+    oneWay.loadGraph(star);
+    oneWay.setUnDirected();
+    CHECK(GraphLib::Algorithms::shortestPath(oneWay, 0, 21) == "There is no path between 0 and 21.");
+    CHECK(GraphLib::Algorithms::shortestPath(oneWay, 0, 21, GraphLib::Algorithms::PARALLEL) == "There is no path between 0 and 21.");
+    CHECK(GraphLib::Algorithms::shortestPath(oneWay, 21, 7) == "There is no path between 21 and 7.");
+}
+
+TEST_CASE("Test BFS keeps the FIFO parents")
+{
+    // 5 is reached from 3 and 4 on the same level, 4 was queued first since its parent 1 was
+    GraphLib::Graph directed;
+    std::vector<std::vector<int>> graph(6, std::vector<int>(6, NO_EDGE));
+    graph[0][1] = graph[0][2] = graph[1][4] = graph[2][3] = graph[3][5] = graph[4][5] = 1;
+    directed.loadGraph(graph);
+    CHECK(directed.isDirected());
+    CHECK(GraphLib::Algorithms::shortestPath(directed, 0, 5) == "The shortest path is: 0->1->4->5");
+    // the undirected graph finds 5 in a bottom-up step
+    for(size_t u = 0; u < 6; u++){
+        for(size_t v = 0; v < u; v++){
+            graph[v][u] = graph[u][v] = std::max(graph[u][v], graph[v][u]);
+        }
+    }
+    GraphLib::Graph undirected;
+    undirected.loadGraph(graph);
+    CHECK_FALSE(undirected.isDirected());
+    CHECK(GraphLib::Algorithms::shortestPath(undirected, 0, 5) == "The shortest path is: 0->1->4->5");
+    CHECK(GraphLib::Algorithms::shortestPath(undirected, 5, 0) == "The shortest path is: 5->3->2->0");
+}
+
+TEST_CASE("Test parallel BFS")
+{
+    // the second level holds 2000 vertices, so it is expanded on all the hardware threads
+    size_t n = 3000;
+    GraphLib::Graph::CSR csr;
+    csr.offsets.push_back(0);
+    for(size_t u = 0; u < n; u++){
+        std::vector<size_t> adjacent;
+        if(u == 0){
+            for(size_t v = 1; v <= 2000; v++){
+                adjacent.push_back(v);
+            }
+        }
+        else if(u <= 2000){
+            adjacent.push_back(0);
+            for(size_t v = 2001; v < n; v++){
+                if(v % 997 == u % 997 || v % 1000 == u % 1000){
+                    adjacent.push_back(v);
+                }
+            }
+        }
+        else{
+            for(size_t v = 1; v <= 2000; v++){
+                if(u % 997 == v % 997 || u % 1000 == v % 1000){
+                    adjacent.push_back(v);
+                }
+            }
+        }
+        for(size_t v : adjacent){
+            csr.cols.push_back(v);
+            csr.weights.push_back(1);
+        }
+        csr.offsets.push_back(csr.cols.size());
+    }
+    GraphLib::Graph sparse;
+    sparse.loadGraph(csr);
+    GraphLib::Graph bits;
+    bits.loadGraph(sparse.getGraph());
+    GraphLib::Graph isolated;
+    isolated.loadGraph(n, GraphLib::Graph::Matrix(n * n, NO_EDGE));
+    CHECK_EQ(!sparse.isDirected() && bits.isBitset(), true);
+    for(const GraphLib::Graph *g : {&sparse, &bits}){
+        for(size_t dst : std::vector<size_t>{2500, 2999, 1500}){
+            std::string path = GraphLib::Algorithms::shortestPath(*g, 0, dst, GraphLib::Algorithms::PARALLEL);
+            CHECK(path == GraphLib::Algorithms::shortestPath(*g, 0, dst));
+        }
+        CHECK(GraphLib::Algorithms::isConnected(*g, GraphLib::Algorithms::PARALLEL) == "The graph is connected.");
+    }
+    CHECK(GraphLib::Algorithms::shortestPath(sparse, 0, 2500, GraphLib::Algorithms::PARALLEL) == "The shortest path is: 0->500->2500");
+    CHECK(GraphLib::Algorithms::isConnected(isolated, GraphLib::Algorithms::PARALLEL) == "The graph is not connected.");
+
+    // a random graph with levels of thousands of vertices finds the paths of a FIFO queue that pops one vertex at a time
+    size_t m = 6000;
+    std::vector<std::vector<size_t>> adjacent(m);
+    uint64_t seed = 1;
+    for(size_t k = 0; k < m * 3; k++){
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t u = (size_t)(seed >> 33) % m;
+        size_t v = (size_t)(seed >> 13) % m;
+        if(u != v){
+            adjacent[u].push_back(v);
+            adjacent[v].push_back(u);
+        }
+    }
+    GraphLib::Graph::CSR randomCsr;
+    randomCsr.offsets.push_back(0);
+    for(std::vector<size_t> &row : adjacent){
+        std::sort(row.begin(), row.end());
+        row.erase(std::unique(row.begin(), row.end()), row.end());
+        randomCsr.cols.insert(randomCsr.cols.end(), row.begin(), row.end());
+        randomCsr.weights.resize(randomCsr.cols.size(), 1);
+        randomCsr.offsets.push_back(randomCsr.cols.size());
+    }
+    GraphLib::Graph random;
+    random.loadGraph(randomCsr);
+    std::vector<int> fifoPre(m, -1);
+    std::vector<size_t> fifo(1, 0);
+    fifoPre[0] = 0;
+    for(size_t k = 0; k < fifo.size(); k++){
+        for(size_t v : adjacent[fifo[k]]){
+            if(fifoPre[v] == -1){
+                fifoPre[v] = (int)fifo[k];
+                fifo.push_back(v);
+            }
+        }
+    }
+    for(size_t k = 1; k < fifo.size(); k += 97){
+        std::string path = std::to_string(fifo[k]);
+        for(size_t v = fifo[k]; v != 0; v = (size_t)fifoPre[v]){
+            path = std::to_string(fifoPre[v]) + "->" + path;
+        }
+        CHECK(GraphLib::Algorithms::shortestPath(random, 0, fifo[k]) == "The shortest path is: " + path);
+        CHECK(GraphLib::Algorithms::shortestPath(random, 0, fifo[k], GraphLib::Algorithms::PARALLEL) == "The shortest path is: " + path);
+    }
+}
+
+TEST_CASE("Test multi source BFS")
+{
+    // a path 0-1-2-3-4-5 with a chord 1-4, and an isolated vertex 6
+    GraphLib::Graph g;
+    std::vector<std::vector<int>> graph(7, std::vector<int>(7, NO_EDGE));
+    for(size_t v = 0; v < 5; v++){
+        graph[v][v + 1] = graph[v + 1][v] = 1;
+    }
+    graph[1][4] = graph[4][1] = 1;
+    g.loadGraph(graph);
+    GraphLib::Algorithms::NearestSource<int64_t> nearest = GraphLib::Algorithms::multiSourceBFS(g, {5, 0, 5});
+    const int64_t inf = GraphLib::infinity<int64_t>();
+    CHECK(nearest.dis == std::vector<int64_t>({0, 1, 2, 2, 1, 0, inf}));
+    CHECK(nearest.owner == std::vector<int>({0, 0, 0, 5, 5, 5, -1}));
+    g.removeEdges({{1, 4}, {4, 1}});
+    // 2 is two edges away from both sources, its parent 1 was reached from 0 and queued before 3
+    nearest = GraphLib::Algorithms::multiSourceBFS(g, {4, 0}, GraphLib::Algorithms::PARALLEL);
+    CHECK(nearest.dis == std::vector<int64_t>({0, 1, 2, 1, 0, 1, inf}));
+    CHECK(nearest.owner == std::vector<int>({0, 0, 0, 4, 4, 4, -1}));
+    nearest = GraphLib::Algorithms::multiSourceBFS(g, {0, 6});
+    CHECK(nearest.owner == std::vector<int>({0, 0, 0, 0, 0, 0, 6}));
+    CHECK(GraphLib::Algorithms::multiSourceBFS(g, {}).owner == std::vector<int>(7, -1));
+    CHECK_THROWS_AS(GraphLib::Algorithms::multiSourceBFS(g, {7}), std::invalid_argument);
+
+    // 70 sources take two bit parallel batches
+    std::vector<size_t> sources;
+    for(size_t k = 0; k < 70; k++){
+        sources.push_back((k * 3) % 7);
+    }
+    std::vector<std::vector<int64_t>> all = GraphLib::Algorithms::sourceDistances(g, sources);
+    CHECK(all.size() == 70);
+    for(size_t k = 0; k < sources.size(); k++){
+        CHECK(all[k] == GraphLib::Algorithms::multiSourceBFS(g, {sources[k]}).dis);
+    }
+    CHECK(all[1] == std::vector<int64_t>({3, 2, 1, 0, 1, 2, inf}));
+    CHECK_THROWS_AS(GraphLib::Algorithms::sourceDistances(g, {0, 9}), std::invalid_argument);
+}
+
+TEST_CASE("Test Dijkstra heaps")
+{
+    const GraphLib::Algorithms::Heap heaps[] = {GraphLib::Algorithms::AUTO_HEAP, GraphLib::Algorithms::DARY_HEAP,
+                                                GraphLib::Algorithms::PAIRING_HEAP, GraphLib::Algorithms::RADIX_HEAP,
+                                                GraphLib::Algorithms::DIAL_BUCKETS};
+    // 1 and 3 are first reached by longer paths and lowered later, 1 and 5 are both 3 away and both give 3
+    // the distance 4, the smaller one settles first and stays its parent
+    GraphLib::Graph g;
+    std::vector<std::vector<int>> graph(7, std::vector<int>(7, NO_EDGE));
+    graph[0][1] = 4;
+    graph[0][2] = 1;
+    graph[2][1] = 2;
+    graph[1][3] = 1;
+    graph[2][3] = 5;
+    graph[0][5] = 3;
+    graph[5][3] = 1;
+    graph[3][4] = 3;
+    g.loadGraph(graph);
+    for(GraphLib::Algorithms::Heap heap : heaps){
+        CHECK(GraphLib::Algorithms::shortestPath(g, 0, 4, GraphLib::Algorithms::SEQUENTIAL, heap) == "The shortest path is: 0->2->1->3->4");
+        CHECK(GraphLib::Algorithms::shortestPath(g, 0, 5, GraphLib::Algorithms::SEQUENTIAL, heap) == "The shortest path is: 0->5");
+        CHECK(GraphLib::Algorithms::shortestPath(g, 4, 0, GraphLib::Algorithms::SEQUENTIAL, heap) == "There is no path between 4 and 0.");
+        CHECK(GraphLib::Algorithms::shortestPath(g, 0, 6, GraphLib::Algorithms::SEQUENTIAL, heap) == "There is no path between 0 and 6.");
+    }
+
+    // a 20x20 grid with weights 1..5, every heap finds the same paths
+    const size_t side = 20;
+    std::vector<std::vector<int>> grid(side * side, std::vector<int>(side * side, NO_EDGE));
+    for(size_t i = 0; i < side; i++){
+        for(size_t j = 0; j < side; j++){
+            size_t v = i * side + j;
+            int w = (int)((i * 7 + j * 3) % 5 + 1);
+            if(j + 1 < side){
+                grid[v][v + 1] = grid[v + 1][v] = w;
+            }
+            if(i + 1 < side){
+                grid[v][v + side] = grid[v + side][v] = w;
+            }
+        }
+    }
+    g.loadGraph(grid);
+    // a full O(V^2) Dijkstra settles the closest vertex, the smallest among equal distances, like the heaps
+    std::vector<int64_t> full(side * side, GraphLib::infinity<int64_t>());
+    std::vector<int> fullPre(side * side, -1);
+    std::vector<bool> settled(side * side, false);
+    full[0] = 0;
+    for(size_t round = 0; round < side * side; round++){
+        size_t u = side * side;
+        for(size_t v = 0; v < side * side; v++){
+            if(!settled[v] && (u == side * side || full[v] < full[u])){
+                u = v;
+            }
+        }
+        settled[u] = true;
+        for(size_t v = 0; v < side * side; v++){
+            if(grid[u][v] != NO_EDGE && full[u] + grid[u][v] < full[v]){
+                full[v] = full[u] + grid[u][v];
+                fullPre[v] = (int)u;
+            }
+        }
+    }
+    for(size_t dst : std::vector<size_t>{399, 210, 19, 380}){
+        std::string path = GraphLib::Algorithms::shortestPath(g, 0, dst);
+        // the search stops at dst, the predecessors on its path are the ones of the full run
+        std::string fullPath = std::to_string(dst);
+        for(size_t v = dst; v != 0; v = (size_t)fullPre[v]){
+            fullPath = std::to_string(fullPre[v]) + "->" + fullPath;
+        }
+        CHECK(path == "The shortest path is: " + fullPath);
+        for(GraphLib::Algorithms::Heap heap : heaps){
+            CHECK(GraphLib::Algorithms::shortestPath(g, 0, dst, GraphLib::Algorithms::SEQUENTIAL, heap) == path);
+        }
+    }
+
+    // floating point weights use the 4-ary heap for RADIX_HEAP and DIAL_BUCKETS
+    GraphLib::BasicGraph<double> real;
+    real.loadGraph(std::vector<std::vector<double>>{{0, 0.5, 2.5}, {0.5, 0, 1.5}, {2.5, 1.5, 0}});
+    for(GraphLib::Algorithms::Heap heap : heaps){
+        CHECK(GraphLib::Algorithms::shortestPath(real, 0, 2, GraphLib::Algorithms::SEQUENTIAL, heap) == "The shortest path is: 0->1->2");
+    }
+}
+
+TEST_CASE("Test Dial buckets")
+{
+    const GraphLib::Algorithms::Execution seq = GraphLib::Algorithms::SEQUENTIAL;
+    // a cycle 0-1-...-9 with weights 1..10 and a chord 0-5 of weight 12
+    GraphLib::Graph g;
+    std::vector<std::vector<int>> graph(10, std::vector<int>(10, NO_EDGE));
+    for(size_t v = 0; v < 10; v++){
+        graph[v][(v + 1) % 10] = graph[(v + 1) % 10][v] = (int)v + 1;
+    }
+    graph[0][5] = graph[5][0] = 12;
+    g.loadGraph(graph);
+    CHECK(g.maxWeightBound() == 12);
+    CHECK(GraphLib::Algorithms::shortestPath(g, 0, 6) == "The shortest path is: 0->5->6");
+    CHECK(GraphLib::Algorithms::shortestPath(g, 0, 6, seq, GraphLib::Algorithms::DIAL_BUCKETS) == "The shortest path is: 0->5->6");
+    CHECK(GraphLib::Algorithms::shortestPath(g, 3, 8, seq, GraphLib::Algorithms::DIAL_BUCKETS) == "The shortest path is: 3->2->1->0->9->8");
+
+    // a heavier edge raises the bound at once, lowering it again keeps the bound until the flags are counted
+    g.setEdge(8, 9, 40);
+    g.setEdge(9, 8, 40);
+    CHECK(g.maxWeightBound() == 40);
+    CHECK(GraphLib::Algorithms::shortestPath(g, 3, 8) == "The shortest path is: 3->4->5->6->7->8");
+    g.setEdge(8, 9, 2);
+    g.setEdge(9, 8, 2);
+    CHECK(g.maxWeightBound() == 40);
+    CHECK(GraphLib::Algorithms::shortestPath(g, 3, 8) == "The shortest path is: 3->2->1->0->9->8");
+    g.updateGraphFlags();
+    CHECK(g.maxWeightBound() == 12);
+
+    // weights above 256 take the 4-ary heap by default, and above 2^20 even when the buckets are asked for
+    g.setEdge(0, 5, 1 << 21);
+    g.setEdge(5, 0, 1 << 21);
+    for(GraphLib::Algorithms::Heap heap : {GraphLib::Algorithms::AUTO_HEAP, GraphLib::Algorithms::DIAL_BUCKETS}){
+        CHECK(GraphLib::Algorithms::shortestPath(g, 0, 6, seq, heap) == "The shortest path is: 0->1->2->3->4->5->6");
+        CHECK(GraphLib::Algorithms::shortestPath(g, 0, 7, seq, heap) == "The shortest path is: 0->9->8->7");
+    }
+
+    // unsigned 8 bit weights up to 255 fill all the buckets
+    GraphLib::BasicGraph<uint8_t> narrow;
+    narrow.loadGraph(std::vector<std::vector<uint8_t>>{{0, 255, 0, 1}, {255, 0, 1, 0}, {0, 1, 0, 254}, {1, 0, 254, 0}});
+    CHECK(narrow.maxWeightBound() == 255);
+    CHECK(GraphLib::Algorithms::shortestPath(narrow, 0, 2) == "The shortest path is: 0->3->2");
+    CHECK(GraphLib::Algorithms::shortestPath(narrow, 0, 1) == "The shortest path is: 0->1");
+
+    // the sum of two directed graphs has no counters yet, the first search finds the largest weight and caches it
+    GraphLib::Graph ring;
+    std::vector<std::vector<int>> arcs(50, std::vector<int>(50, NO_EDGE));
+    for(size_t v = 0; v < 50; v++){
+        arcs[v][(v + 1) % 50] = (int)(v % 4) + 1;
+        arcs[v][(v + 7) % 50] = 20;
+    }
+    ring.loadGraph(arcs);
+    const GraphLib::Graph twice = ring + ring;
+    int bound = 0;
+    CHECK_FALSE(twice.cachedMaxWeightBound(bound));
+    std::vector<std::string> paths(4);
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < 4; t++){
+        threads.emplace_back([&, t](){paths[t] = GraphLib::Algorithms::shortestPath(twice, 0, 49);});
+    }
+    for(std::thread &thread : threads){
+        thread.join();
+    }
+    CHECK(paths == std::vector<std::string>(4, GraphLib::Algorithms::shortestPath(twice, 0, 49, seq, GraphLib::Algorithms::DARY_HEAP)));
+    CHECK_EQ(twice.cachedMaxWeightBound(bound) && bound == 40, true);
+    CHECK_EQ(twice.maxWeightBound(), 40);
+    // a changed matrix drops the cached weight with the counters
+    GraphLib::Graph changed = ring + ring;
+    CHECK_EQ(changed.maxWeightBound(), 40);
+    changed *= 2;
+    CHECK_FALSE(changed.cachedMaxWeightBound(bound));
+    CHECK_EQ(changed.maxWeightBound(), 80);
+}
+
+TEST_CASE("Test concurrent const calls")
+{
+    // the key and the counters of a fresh copy are filled by the first const call of any thread
+    std::vector<std::vector<int>> graph(200, std::vector<int>(200, NO_EDGE));
+    for(size_t i = 0; i < 200; i++){
+        graph[i][(i * 7 + 3) % 200] = (int)(i % 5) + 1;
+    }
+    GraphLib::Graph g;
+    g.loadGraph(graph);
+    GraphLib::Graph h = g + g;
+    h -= g;
+    const GraphLib::Graph &a = g;
+    const GraphLib::Graph &b = h;
+    std::vector<int> equal(4, 0);
+    std::vector<int> edges(4, 0);
+    std::vector<int> heaviest(4, 0);
+    std::vector<std::thread> threads;
+    for(size_t t = 0; t < 4; t++){
+        threads.emplace_back([&, t](){
+            equal[t] = a == b && !(a < b) && a.hash() == b.hash();
+            edges[t] = b.countEdges();
+            heaviest[t] = b.maxWeightBound();
+        });
+    }
+    for(std::thread &thread : threads){
+        thread.join();
+    }
+    CHECK(equal == std::vector<int>(4, 1));
+    CHECK(edges == std::vector<int>(4, 200));
+    CHECK(heaviest == std::vector<int>(4, 5));
+}